@@ -0,0 +1,346 @@
+#include "../include/AnalysisServer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+std::string formatMove(const Board& board, const Move& move) {
+    static const char promotions[] = " pnbrqkpnbrqk";
+    std::string text = board.squareToAlgebraic(move.from) + board.squareToAlgebraic(move.to);
+    if (move.promotion != EMPTY) text += promotions[move.promotion];
+    return text;
+}
+
+// Parses a flat JSON object. String values are unescaped; numbers and
+// literals are kept as their source text. Nested values are rejected.
+bool parseObject(const std::string& line, std::map<std::string, std::string>& fields, std::map<std::string, bool>& quoted) {
+    size_t pos = 0;
+    auto skipSpace = [&]() {
+        while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) pos++;
+    };
+    auto readString = [&](std::string& out) {
+        if (pos >= line.size() || line[pos] != '"') return false;
+        for (pos++; pos < line.size(); pos++) {
+            char c = line[pos];
+            if (c == '"') {
+                pos++;
+                return true;
+            }
+            if (c == '\\') {
+                if (++pos >= line.size()) return false;
+                c = line[pos];
+                if (c == 'n') c = '\n';
+                else if (c == 't') c = '\t';
+            }
+            out += c;
+        }
+        return false;
+    };
+
+    skipSpace();
+    if (pos >= line.size() || line[pos++] != '{') return false;
+    skipSpace();
+    if (pos < line.size() && line[pos] == '}') return true;
+    while (pos < line.size()) {
+        std::string key, value;
+        skipSpace();
+        if (!readString(key)) return false;
+        skipSpace();
+        if (pos >= line.size() || line[pos++] != ':') return false;
+        skipSpace();
+        if (pos < line.size() && line[pos] == '"') {
+            if (!readString(value)) return false;
+            quoted[key] = true;
+        } else {
+            while (pos < line.size() && line[pos] != ',' && line[pos] != '}' &&
+                   !std::isspace(static_cast<unsigned char>(line[pos]))) {
+                if (line[pos] == '{' || line[pos] == '[') return false;
+                value += line[pos++];
+            }
+            if (value.empty()) return false;
+            quoted[key] = false;
+        }
+        fields[key] = value;
+        skipSpace();
+        if (pos >= line.size()) return false;
+        if (line[pos] == '}') return true;
+        if (line[pos++] != ',') return false;
+    }
+    return false;
+}
+
+// JSON number grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isNumber(const std::string& text) {
+    size_t pos = 0;
+    auto digits = [&]() {
+        size_t start = pos;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) pos++;
+        return pos > start;
+    };
+    if (pos < text.size() && text[pos] == '-') pos++;
+    if (pos < text.size() && text[pos] == '0') pos++;
+    else if (!digits()) return false;
+    if (pos < text.size() && text[pos] == '.') {
+        pos++;
+        if (!digits()) return false;
+    }
+    if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+        pos++;
+        if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) pos++;
+        if (!digits()) return false;
+    }
+    return pos == text.size();
+}
+
+// loadFromFEN checks the pieces but not whose turn it is: the side that
+// just moved must not be left in check
+bool isLegalPosition(const Board& board) {
+    return !board.isInCheck(board.getCurrentPlayer() == WHITE ? BLACK : WHITE);
+}
+
+double percentile(std::vector<double> samples, double fraction) {
+    if (samples.empty()) return 0.0;
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+} // namespace
+
+AnalysisServer::AnalysisServer(const ServerOptions& serverOptions)
+    : options(serverOptions), stopping(false), requestCount(0), searchCount(0), cacheHits(0),
+      coalescedCount(0), nextLatency(0), startTime(std::chrono::steady_clock::now()) {
+    latencies.reserve(LATENCY_SAMPLES);
+    for (int i = 0; i < std::max(1, options.workers); i++) {
+        workers.emplace_back(&AnalysisServer::workerLoop, this);
+    }
+}
+
+AnalysisServer::~AnalysisServer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (std::thread& worker : workers) worker.join();
+
+    // Nothing waits for jobs that never started once the server is gone,
+    // but their promises must not be left unsatisfied
+    for (std::unique_ptr<Job>& job : queue) {
+        AnalysisResult result;
+        result.error = "server stopped";
+        job->promise.set_value(result);
+    }
+}
+
+void AnalysisServer::workerLoop() {
+    // Each worker keeps its engine, and with it the transposition table,
+    // across requests
+    Search search(options.engine);
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        SearchLimits limits;
+        limits.depth = job->key.depth;
+        limits.moveTimeMs = options.maxTimeMs;
+        SearchResult searched = search.think(job->board, limits);
+
+        AnalysisResult result;
+        result.ok = true;
+        result.score = searched.score;
+        result.depth = searched.depth;
+        result.nodes = searched.nodes;
+        Board line = job->board;
+        for (const Move& move : searched.pv) {
+            result.pv.push_back(formatMove(line, move));
+            line.applyMove(move);
+        }
+        if (searched.bestMove.from >= 0) result.bestMove = formatMove(job->board, searched.bestMove);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            searchCount++;
+            inFlight.erase(job->key);
+            // A search cut short by the time cap does not answer the
+            // requested depth, so later requests search again. One that
+            // stopped early on a forced mate does.
+            bool complete = searched.depth >= job->key.depth || Search::isMateScore(searched.score);
+            if (options.cacheEntries > 0 && complete) {
+                cache.emplace_front(job->key, result);
+                cacheIndex[job->key] = cache.begin();
+                if (cache.size() > options.cacheEntries) {
+                    cacheIndex.erase(cache.back().first);
+                    cache.pop_back();
+                }
+            }
+        }
+        job->promise.set_value(result);
+    }
+}
+
+void AnalysisServer::recordLatency(std::chrono::steady_clock::time_point start) {
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (latencies.size() < LATENCY_SAMPLES) {
+        latencies.push_back(ms);
+    } else {
+        latencies[nextLatency] = ms;
+        nextLatency = (nextLatency + 1) % LATENCY_SAMPLES;
+    }
+}
+
+AnalysisResult AnalysisServer::analyse(const std::string& fen, int depth) {
+    auto start = std::chrono::steady_clock::now();
+    AnalysisResult result;
+
+    std::unique_ptr<Job> job(new Job());
+    if (!job->board.loadFromFEN(fen)) {
+        result.error = "invalid fen";
+    } else if (!isLegalPosition(job->board)) {
+        result.error = "invalid position";
+    } else if (depth < 1) {
+        result.error = "invalid depth";
+    } else {
+        TerminalReason terminal = job->board.getStatus().terminal;
+        if (terminal == TERMINAL_CHECKMATE || terminal == TERMINAL_STALEMATE) {
+            result.ok = true;
+            result.terminal = terminal;
+            result.score = terminal == TERMINAL_CHECKMATE ? -Search::MATE_SCORE : 0;
+        }
+    }
+    if (!result.error.empty() || result.terminal != NOT_TERMINAL) {
+        std::lock_guard<std::mutex> lock(mutex);
+        requestCount++;
+        return result;
+    }
+    job->key.hash = job->board.getHash();
+    job->key.depth = std::min(depth, std::min(options.maxDepth, Search::MAX_PLY - 1));
+
+    std::shared_future<AnalysisResult> pending;
+    bool coalesced = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requestCount++;
+        auto cached = cacheIndex.find(job->key);
+        if (cached != cacheIndex.end()) {
+            cacheHits++;
+            cache.splice(cache.begin(), cache, cached->second);
+            result = cached->second->second;
+        } else {
+            auto running = inFlight.find(job->key);
+            if (running != inFlight.end()) {
+                coalescedCount++;
+                coalesced = true;
+                pending = running->second;
+            } else {
+                pending = job->promise.get_future().share();
+                inFlight[job->key] = pending;
+                queue.push_back(std::move(job));
+                jobAvailable.notify_one();
+            }
+        }
+    }
+
+    if (pending.valid()) {
+        result = pending.get();
+        result.coalesced = coalesced;
+    } else {
+        result.cached = true;
+    }
+    recordLatency(start);
+    return result;
+}
+
+ServerStats AnalysisServer::getStats() const {
+    std::vector<double> samples;
+    ServerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        samples = latencies;
+        stats.requests = requestCount;
+        stats.searches = searchCount;
+        stats.cacheHits = cacheHits;
+        stats.coalesced = coalescedCount;
+        stats.cacheEntries = cache.size();
+    }
+    stats.uptimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    stats.requestsPerSecond = stats.uptimeSeconds > 0 ? stats.requests / stats.uptimeSeconds : 0.0;
+    stats.p50Ms = percentile(samples, 0.50);
+    stats.p99Ms = percentile(samples, 0.99);
+    return stats;
+}
+
+std::string AnalysisServer::handleLine(const std::string& line) {
+    std::map<std::string, std::string> fields;
+    std::map<std::string, bool> quoted;
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "{";
+
+    if (!parseObject(line, fields, quoted)) {
+        out << "\"ok\": false, \"error\": \"malformed request\"}";
+        return out.str();
+    }
+    // Anything but a string or a number would break the reply
+    if (fields.count("id")) {
+        if (!quoted["id"] && !isNumber(fields["id"])) {
+            out << "\"ok\": false, \"error\": \"invalid id\"}";
+            return out.str();
+        }
+        out << "\"id\": " << (quoted["id"] ? SearchStats::quoteJson(fields["id"]) : fields["id"]) << ", ";
+    }
+
+    std::string command = fields.count("cmd") ? fields["cmd"] : "analyse";
+    if (command == "stats") {
+        ServerStats stats = getStats();
+        out << "\"ok\": true, \"requests\": " << stats.requests << ", \"searches\": " << stats.searches
+            << ", \"cacheHits\": " << stats.cacheHits << ", \"coalesced\": " << stats.coalesced
+            << ", \"cacheEntries\": " << stats.cacheEntries << ", \"workers\": " << workers.size()
+            << ", \"uptimeSeconds\": " << stats.uptimeSeconds << ", \"requestsPerSecond\": " << stats.requestsPerSecond
+            << ", \"p50Ms\": " << stats.p50Ms << ", \"p99Ms\": " << stats.p99Ms << "}";
+        return out.str();
+    }
+    if (command != "analyse") {
+        out << "\"ok\": false, \"error\": \"unknown command\"}";
+        return out.str();
+    }
+
+    std::string fen = fields.count("fen") ? fields["fen"] : START_FEN;
+    int depth = fields.count("depth") ? std::atoi(fields["depth"].c_str()) : 8;
+    AnalysisResult result = analyse(fen, depth);
+    if (!result.ok) {
+        out << "\"ok\": false, \"error\": " << SearchStats::quoteJson(result.error) << "}";
+        return out.str();
+    }
+    if (result.terminal != NOT_TERMINAL) {
+        out << "\"ok\": true, \"terminal\": "
+            << (result.terminal == TERMINAL_CHECKMATE ? "\"checkmate\"" : "\"stalemate\"")
+            << ", \"score\": " << result.score << "}";
+        return out.str();
+    }
+
+    out << "\"ok\": true, \"bestmove\": " << SearchStats::quoteJson(result.bestMove) << ", \"score\": " << result.score;
+    if (Search::isMateScore(result.score)) {
+        int plies = Search::MATE_SCORE - std::abs(result.score);
+        out << ", \"mate\": " << (result.score > 0 ? (plies + 1) / 2 : -(plies / 2));
+    }
+    out << ", \"depth\": " << result.depth << ", \"nodes\": " << result.nodes << ", \"pv\": [";
+    for (size_t i = 0; i < result.pv.size(); i++) {
+        out << (i ? ", " : "") << SearchStats::quoteJson(result.pv[i]);
+    }
+    out << "], \"cached\": " << (result.cached ? "true" : "false")
+        << ", \"coalesced\": " << (result.coalesced ? "true" : "false") << "}";
+    return out.str();
+}
@@ -0,0 +1,122 @@
+#ifndef ANALYSIS_SERVER_H
+#define ANALYSIS_SERVER_H
+
+#include "Board.h"
+#include "Search.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct ServerOptions {
+    int workers;            // Searchers, each with its own Search and Board
+    size_t cacheEntries;    // LRU result cache size, 0 disables the cache
+    int maxDepth;           // Deeper requests are clamped to this
+    int maxTimeMs;          // Per-search time cap, 0 = unlimited
+    EngineConfig engine;
+
+    ServerOptions() : workers(2), cacheEntries(4096), maxDepth(20), maxTimeMs(10000) {}
+};
+
+struct AnalysisResult {
+    bool ok;
+    std::string error;
+    TerminalReason terminal;        // Checkmate or stalemate: no move to search
+    std::string bestMove;           // Coordinate notation, "e2e4", "e7e8q"
+    int score;                      // Centipawns, side to move's point of view
+    int depth;
+    uint64_t nodes;
+    std::vector<std::string> pv;
+    bool cached;                    // Answered from the result cache
+    bool coalesced;                 // Shared the search of an identical request
+
+    AnalysisResult() : ok(false), terminal(NOT_TERMINAL), score(0), depth(0), nodes(0), cached(false), coalesced(false) {}
+};
+
+struct ServerStats {
+    uint64_t requests;
+    uint64_t searches;
+    uint64_t cacheHits;
+    uint64_t coalesced;
+    size_t cacheEntries;
+    double uptimeSeconds;
+    double requestsPerSecond;
+    double p50Ms;                   // Over the most recent requests
+    double p99Ms;
+};
+
+// Answers "analyse this FEN to depth D" for many clients at once.
+// Requests for a position and depth already being searched wait for that
+// search instead of starting another, and finished results are kept in an
+// LRU cache keyed by Zobrist hash and depth. The caller owns the
+// transport; handleLine() speaks the newline-delimited JSON protocol.
+class AnalysisServer {
+private:
+    struct Key {
+        uint64_t hash;
+        int depth;
+        bool operator==(const Key& other) const { return hash == other.hash && depth == other.depth; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash ^ (uint64_t(key.depth) << 56)); }
+    };
+    struct Job {
+        Key key;
+        Board board;
+        std::promise<AnalysisResult> promise;
+    };
+    typedef std::list<std::pair<Key, AnalysisResult>> CacheList;
+
+    static const size_t LATENCY_SAMPLES = 10000;
+
+    ServerOptions options;
+    std::vector<std::thread> workers;
+    std::deque<std::unique_ptr<Job>> queue;
+    std::unordered_map<Key, std::shared_future<AnalysisResult>, KeyHash> inFlight;
+    CacheList cache;                // Most recently used first
+    std::unordered_map<Key, CacheList::iterator, KeyHash> cacheIndex;
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;
+    bool stopping;
+
+    // Guarded by mutex
+    uint64_t requestCount;
+    uint64_t searchCount;
+    uint64_t cacheHits;
+    uint64_t coalescedCount;
+    std::vector<double> latencies;  // Ring buffer of milliseconds
+    size_t nextLatency;
+    std::chrono::steady_clock::time_point startTime;
+
+    void workerLoop();
+    void recordLatency(std::chrono::steady_clock::time_point start);
+
+public:
+    explicit AnalysisServer(const ServerOptions& options = ServerOptions());
+    ~AnalysisServer();
+
+    AnalysisServer(const AnalysisServer&) = delete;
+    AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+    // Blocks until the result is available; safe to call from many threads
+    AnalysisResult analyse(const std::string& fen, int depth);
+    ServerStats getStats() const;
+
+    // One request line in, one reply line out (without the newline):
+    //   {"id": 1, "cmd": "analyse", "fen": "...", "depth": 8}
+    //   {"id": 2, "cmd": "stats"}
+    // "cmd" defaults to "analyse" and "fen" to the starting position; "id"
+    // is echoed back if it is a string or a number. A checkmated or
+    // stalemated side to move gets "terminal" instead of a best move.
+    std::string handleLine(const std::string& line);
+};
+
+#endif // ANALYSIS_SERVER_H
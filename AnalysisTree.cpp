@@ -0,0 +1,209 @@
+#include "../include/AnalysisTree.h"
+#include "../include/TranspositionTable.h"
+
+namespace {
+
+// Rebuilds a move stored by addMove from the position it is played in.
+// It was checked for legality when added, so the flags follow from the
+// squares alone and no move generation is needed.
+Move unpackMove(const Board& board, uint16_t code) {
+    int from = code & 0x3F;
+    int to = (code >> 6) & 0x3F;
+    int promotion = code >> 12;
+
+    Move move(from, to, board.getPiece(from));
+    move.captured = board.getPiece(to);
+    if (move.piece == W_PAWN || move.piece == B_PAWN) {
+        int distance = to > from ? to - from : from - to;
+        move.isDoublePawnPush = distance == 16;
+        move.isEnPassant = move.captured == EMPTY && distance % 8 != 0;
+        if (promotion != 0) {
+            move.promotion = static_cast<Piece>((move.piece == W_PAWN ? W_PAWN : B_PAWN) + promotion);
+        }
+    } else if (move.piece == W_KING || move.piece == B_KING) {
+        move.isCastling = to - from == 2 || from - to == 2;
+    }
+    return move;
+}
+
+} // namespace
+
+// Bound to references by std::vector::assign
+const uint32_t AnalysisTree::NO_NODE;
+const uint32_t AnalysisTree::ROOT;
+
+AnalysisTree::AnalysisTree() : slotMask(0), currentNode(ROOT) {
+    reset();
+}
+
+bool AnalysisTree::reset(const std::string& fen) {
+    Board start;
+    if (!fen.empty() && !start.loadFromFEN(fen)) return false;
+    board = start;
+
+    nodes.clear();
+    positions.clear();
+    slots.assign(1024, NO_NODE);
+    slotMask = slots.size() - 1;
+
+    Node root = {NO_NODE, NO_NODE, NO_NODE, 0, NO_NODE, 0, 0};
+    nodes.push_back(root);
+    nodes[ROOT].position = addPosition(board.getHash(), ROOT);
+    currentNode = ROOT;
+    return true;
+}
+
+void AnalysisTree::reserve(size_t nodeCount) {
+    nodes.reserve(nodeCount);
+}
+
+// Zobrist keys are uniform in their low bits, so they index the slots as is
+uint32_t AnalysisTree::findPosition(uint64_t hash) const {
+    for (size_t i = hash & slotMask;; i = (i + 1) & slotMask) {
+        uint32_t index = slots[i];
+        if (index == NO_NODE || positions[index].hash == hash) return index;
+    }
+}
+
+uint32_t AnalysisTree::addPosition(uint64_t hash, uint32_t node) {
+    uint32_t index = findPosition(hash);
+    if (index != NO_NODE) {
+        // Newest first; the list order carries no meaning
+        nodes[node].nextTransposition = positions[index].firstNode;
+        positions[index].firstNode = node;
+        return index;
+    }
+
+    index = static_cast<uint32_t>(positions.size());
+    Position position = {hash, node, 0, -1};
+    positions.push_back(position);
+    size_t i = hash & slotMask;
+    while (slots[i] != NO_NODE) i = (i + 1) & slotMask;
+    slots[i] = index;
+
+    // At most half full, so probe chains stay short
+    if (positions.size() * 2 > slots.size()) growSlots();
+    return index;
+}
+
+void AnalysisTree::growSlots() {
+    slots.assign(slots.size() * 2, NO_NODE);
+    slotMask = slots.size() - 1;
+    for (uint32_t index = 0; index < positions.size(); index++) {
+        size_t i = positions[index].hash & slotMask;
+        while (slots[i] != NO_NODE) i = (i + 1) & slotMask;
+        slots[i] = index;
+    }
+}
+
+uint32_t AnalysisTree::findChild(uint32_t node, const Move& move) const {
+    uint16_t code = TranspositionTable::packMove(move);
+    for (uint32_t child = nodes[node].firstChild; child != NO_NODE; child = nodes[child].nextSibling) {
+        if (nodes[child].move == code) return child;
+    }
+    return NO_NODE;
+}
+
+uint32_t AnalysisTree::addMove(const Move& move) {
+    uint32_t existing = findChild(currentNode, move);
+    if (existing != NO_NODE) return existing;
+    if (nodes[currentNode].ply == UINT16_MAX || nodes.size() >= NO_NODE || !board.isValidMove(move)) {
+        return NO_NODE;
+    }
+
+    uint32_t child = static_cast<uint32_t>(nodes.size());
+    uint16_t code = TranspositionTable::packMove(move);
+    Node node = {currentNode, NO_NODE, NO_NODE, 0, NO_NODE, code,
+                 static_cast<uint16_t>(nodes[currentNode].ply + 1)};
+    nodes.push_back(node);
+
+    // Sidelines go after the main line and the sidelines already there
+    uint32_t* link = &nodes[currentNode].firstChild;
+    while (*link != NO_NODE) link = &nodes[*link].nextSibling;
+    *link = child;
+
+    // Only the hash of the new position is needed
+    Move full = unpackMove(board, code);
+    board.applyMove(full);
+    uint64_t hash = board.getHash();
+    board.undoMove();
+    nodes[child].position = addPosition(hash, child);
+    return child;
+}
+
+bool AnalysisTree::goTo(uint32_t target) {
+    if (target >= nodes.size()) return false;
+
+    // Up from the current node to the common ancestor, collecting the
+    // target's side of the path on the way
+    path.clear();
+    uint32_t up = currentNode, down = target;
+    while (nodes[up].ply > nodes[down].ply) {
+        board.undoMove();
+        up = nodes[up].parent;
+    }
+    while (nodes[down].ply > nodes[up].ply) {
+        path.push_back(down);
+        down = nodes[down].parent;
+    }
+    while (up != down) {
+        board.undoMove();
+        up = nodes[up].parent;
+        path.push_back(down);
+        down = nodes[down].parent;
+    }
+
+    for (size_t i = path.size(); i-- > 0;) {
+        board.applyMove(unpackMove(board, nodes[path[i]].move));
+    }
+    currentNode = target;
+    return true;
+}
+
+void AnalysisTree::promoteVariation(uint32_t node) {
+    if (node == ROOT || node >= nodes.size()) return;
+    uint32_t* link = &nodes[nodes[node].parent].firstChild;
+    if (*link == node) return;
+    while (*link != node) link = &nodes[*link].nextSibling;
+    *link = nodes[node].nextSibling;
+    nodes[node].nextSibling = nodes[nodes[node].parent].firstChild;
+    nodes[nodes[node].parent].firstChild = node;
+}
+
+std::string AnalysisTree::moveText(uint32_t node) const {
+    if (node == ROOT) return "";
+    uint16_t code = nodes[node].move;
+    std::string text = board.squareToAlgebraic(code & 0x3F) + board.squareToAlgebraic((code >> 6) & 0x3F);
+    int promotion = code >> 12;
+    if (promotion != 0) text += "NBRQ"[promotion - 1];
+    return text;
+}
+
+std::vector<uint32_t> AnalysisTree::transpositions(uint32_t node) const {
+    std::vector<uint32_t> result;
+    for (uint32_t other = positions[nodes[node].position].firstNode; other != NO_NODE;
+         other = nodes[other].nextTransposition) {
+        result.push_back(other);
+    }
+    return result;
+}
+
+void AnalysisTree::setAnalysis(uint32_t node, int score, int depth) {
+    Position& position = positions[nodes[node].position];
+    if (depth < position.depth) return;
+    position.score = static_cast<int16_t>(score);
+    position.depth = static_cast<int8_t>(depth > INT8_MAX ? INT8_MAX : depth);
+}
+
+bool AnalysisTree::getAnalysis(uint32_t node, int& score, int& depth) const {
+    const Position& position = positions[nodes[node].position];
+    if (position.depth < 0) return false;
+    score = position.score;
+    depth = position.depth;
+    return true;
+}
+
+size_t AnalysisTree::memoryUsage() const {
+    return nodes.capacity() * sizeof(Node) + positions.capacity() * sizeof(Position) +
+           slots.capacity() * sizeof(uint32_t);
+}
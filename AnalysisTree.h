@@ -0,0 +1,97 @@
+#ifndef ANALYSIS_TREE_H
+#define ANALYSIS_TREE_H
+
+#include "Board.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A tree of variations below one root position, for exploring sidelines
+// without replaying the game from the start. Nodes are indices into one
+// array and hold a packed move instead of a position. Positions reached by
+// more than one line share a single record, found by Zobrist hash, which
+// holds the analysis stored for them.
+//
+// The tree keeps one board at the current node. goTo() walks up to the
+// common ancestor with undoMove and down to the target with applyMove, so
+// moving between nearby nodes costs a few plies, not a replay.
+class AnalysisTree {
+public:
+    static const uint32_t NO_NODE = 0xFFFFFFFF;
+    static const uint32_t ROOT = 0;
+
+private:
+    struct Node {
+        uint32_t parent;
+        uint32_t firstChild;        // Main line first, then sidelines by nextSibling
+        uint32_t nextSibling;
+        uint32_t position;          // Index into positions
+        uint32_t nextTransposition; // Next node with the same position
+        uint16_t move;              // TranspositionTable::packMove, 0 at the root
+        uint16_t ply;
+    };
+
+    struct Position {
+        uint64_t hash;
+        uint32_t firstNode;         // Head of the nodes' nextTransposition list
+        int16_t score;              // For the side to move
+        int8_t depth;               // -1 until analysed
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Position> positions;
+    std::vector<uint32_t> slots;    // Open-addressed hash index into positions
+    size_t slotMask;
+
+    Board board;                    // The position at currentNode
+    uint32_t currentNode;
+    std::vector<uint32_t> path;     // Scratch for goTo
+
+    uint32_t findPosition(uint64_t hash) const;
+    uint32_t addPosition(uint64_t hash, uint32_t node);
+    void growSlots();
+
+public:
+    AnalysisTree();
+
+    // Empties the tree and roots it at fen (empty for the standard start)
+    bool reset(const std::string& fen = "");
+    void reserve(size_t nodeCount);
+
+    // The child of the current node for a legal move, added after the
+    // existing children if new. Returns NO_NODE if the move is illegal.
+    uint32_t addMove(const Move& move);
+    uint32_t findChild(uint32_t node, const Move& move) const;
+
+    bool goTo(uint32_t node);
+    bool goToParent() { return currentNode != ROOT && goTo(nodes[currentNode].parent); }
+    uint32_t current() const { return currentNode; }
+    const Board& getBoard() const { return board; }
+
+    // Makes node the first child of its parent, i.e. the main line
+    void promoteVariation(uint32_t node);
+
+    // Structure; NO_NODE where there is none
+    uint32_t parent(uint32_t node) const { return node == ROOT ? NO_NODE : nodes[node].parent; }
+    uint32_t firstChild(uint32_t node) const { return nodes[node].firstChild; }
+    uint32_t nextSibling(uint32_t node) const { return nodes[node].nextSibling; }
+    uint16_t packedMove(uint32_t node) const { return nodes[node].move; }
+    int ply(uint32_t node) const { return nodes[node].ply; }
+    // Coordinate notation of the move into node, e.g. "e2e4", "e7e8Q"
+    std::string moveText(uint32_t node) const;
+    // Every node with the same position as node, node included
+    std::vector<uint32_t> transpositions(uint32_t node) const;
+
+    // Analysis is kept per position, so every transposition sees it. A
+    // shallower result does not replace a deeper one.
+    void setAnalysis(uint32_t node, int score, int depth);
+    bool getAnalysis(uint32_t node, int& score, int& depth) const;
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t positionCount() const { return positions.size(); }
+    // Bytes held by the tree's arrays, reserved capacity included
+    size_t memoryUsage() const;
+};
+
+#endif // ANALYSIS_TREE_H
@@ -0,0 +1,424 @@
+#include "../include/BatchEvaluation.h"
+#include "../include/Simd.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Knight targets and slider rays per square. Directions 0-3 are diagonal,
+// 4-7 straight.
+struct Geometry {
+    int knightCount[64];
+    int knight[64][8];
+    int rayLength[64][8];
+    int ray[64][8][7];
+};
+
+Geometry buildGeometry() {
+    static const int knightSteps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+    static const int directions[8][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}, {-1, 0}, {0, -1}, {0, 1}, {1, 0}};
+
+    Geometry geometry;
+    for (int square = 0; square < 64; square++) {
+        int rank = square / 8, file = square % 8;
+        geometry.knightCount[square] = 0;
+        for (const auto& step : knightSteps) {
+            int r = rank + step[0], f = file + step[1];
+            if (r >= 0 && r < 8 && f >= 0 && f < 8) {
+                geometry.knight[square][geometry.knightCount[square]++] = r * 8 + f;
+            }
+        }
+        for (int d = 0; d < 8; d++) {
+            int length = 0;
+            for (int r = rank + directions[d][0], f = file + directions[d][1];
+                 r >= 0 && r < 8 && f >= 0 && f < 8; r += directions[d][0], f += directions[d][1]) {
+                geometry.ray[square][d][length++] = r * 8 + f;
+            }
+            geometry.rayLength[square][d] = length;
+        }
+    }
+    return geometry;
+}
+
+const Geometry& geometry() {
+    static const Geometry table = buildGeometry();
+    return table;
+}
+
+// Empty or held by the other side
+bool isTarget(int piece, bool white) {
+    return piece == EMPTY || (piece <= W_KING) != white;
+}
+
+// The scalar definition of the features; pieceAt(square) gives the piece code
+template <class PieceAt>
+EvalFeatures computeFeatures(const PieceAt& pieceAt, const EvalWeights& weights) {
+    const Geometry& geo = geometry();
+    EvalFeatures features = {0, 0, 0};
+    for (int square = 0; square < 64; square++) {
+        int piece = pieceAt(square);
+        if (piece == EMPTY) continue;
+
+        bool white = piece <= W_KING;
+        int sign = white ? 1 : -1;
+        PieceType type = pieceType(static_cast<Piece>(piece));
+        features.material += sign * weights.pieceValue[type];
+        features.pieceSquare += sign * weights.pieceSquare[type][white ? square : square ^ 56];
+
+        int targets = 0;
+        if (type == KNIGHT) {
+            for (int i = 0; i < geo.knightCount[square]; i++) {
+                targets += isTarget(pieceAt(geo.knight[square][i]), white);
+            }
+        } else if (type == BISHOP || type == ROOK || type == QUEEN) {
+            int first = (type == ROOK) ? 4 : 0;
+            int last = (type == BISHOP) ? 4 : 8;
+            for (int d = first; d < last; d++) {
+                for (int i = 0; i < geo.rayLength[square][d]; i++) {
+                    int target = pieceAt(geo.ray[square][d][i]);
+                    if (isTarget(target, white)) targets++;
+                    if (target != EMPTY) break;
+                }
+            }
+        }
+        features.mobility += sign * targets;
+    }
+    return features;
+}
+
+// Processing order for the mobility fill in each direction: every ray is
+// walked from the edge it starts at, so a square follows its neighbour
+struct RayOrder {
+    int square[64];
+    bool lineStart[64];
+};
+
+// Knight moves grouped by step, as from/to pairs
+struct KnightStep {
+    int count;
+    int from[64];
+    int to[64];
+};
+
+struct FillGeometry {
+    RayOrder rays[8];
+    KnightStep knights[8];
+};
+
+FillGeometry buildFillGeometry() {
+    static const int knightSteps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+    const Geometry& geo = geometry();
+    FillGeometry fill;
+    for (int d = 0; d < 8; d++) {
+        int opposite = d < 4 ? 3 - d : 11 - d;
+        int length = 0;
+        for (int square = 0; square < 64; square++) {
+            if (geo.rayLength[square][opposite] != 0) continue;
+            fill.rays[d].square[length] = square;
+            fill.rays[d].lineStart[length++] = true;
+            for (int i = 0; i < geo.rayLength[square][d]; i++) {
+                fill.rays[d].square[length] = geo.ray[square][d][i];
+                fill.rays[d].lineStart[length++] = false;
+            }
+        }
+    }
+    for (int k = 0; k < 8; k++) {
+        KnightStep& step = fill.knights[k];
+        step.count = 0;
+        for (int square = 0; square < 64; square++) {
+            int r = square / 8 + knightSteps[k][0], f = square % 8 + knightSteps[k][1];
+            if (r < 0 || r > 7 || f < 0 || f > 7) continue;
+            step.from[step.count] = square;
+            step.to[step.count++] = r * 8 + f;
+        }
+    }
+    return fill;
+}
+
+const FillGeometry& fillGeometry() {
+    static const FillGeometry table = buildFillGeometry();
+    return table;
+}
+
+#ifdef CHESS_X86_64
+
+// The vector kernels work on one byte per position, 16 (SSE4.1) or 32
+// (AVX2) positions at a time:
+// - material counts each piece code over the board, then multiplies
+// - piece-square values are looked up with pshufb as low and high bytes of
+//   an int16 and summed as int16, which the weight limit keeps exact
+// - mobility fills each slider direction and knight step across the whole
+//   board. One pass adds at most 64 per side, so it fits a signed byte
+//   before being widened.
+
+TARGET_SSE41 void evaluateSse41(const PositionBatch& batch, const BatchTables& tables, int32_t* material,
+                                int32_t* pieceSquare, int32_t* mobility) {
+    const FillGeometry& fill = fillGeometry();
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+
+    for (size_t index = 0; index < batch.size(); index += 16) {
+        __m128i codes[64], empty[64], notWhite[64], notBlack[64];
+        __m128i diagonalW[64], diagonalB[64], straightW[64], straightB[64], knightW[64], knightB[64];
+        for (int square = 0; square < 64; square++) {
+            __m128i code = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.square(square) + index));
+            __m128i black = _mm_cmpgt_epi8(code, _mm_set1_epi8(6));
+            codes[square] = code;
+            empty[square] = _mm_cmpeq_epi8(code, zero);
+            notBlack[square] = _mm_xor_si128(black, ones);
+            notWhite[square] = _mm_or_si128(empty[square], black);
+            __m128i queenW = _mm_cmpeq_epi8(code, _mm_set1_epi8(W_QUEEN));
+            __m128i queenB = _mm_cmpeq_epi8(code, _mm_set1_epi8(B_QUEEN));
+            diagonalW[square] = _mm_or_si128(queenW, _mm_cmpeq_epi8(code, _mm_set1_epi8(W_BISHOP)));
+            diagonalB[square] = _mm_or_si128(queenB, _mm_cmpeq_epi8(code, _mm_set1_epi8(B_BISHOP)));
+            straightW[square] = _mm_or_si128(queenW, _mm_cmpeq_epi8(code, _mm_set1_epi8(W_ROOK)));
+            straightB[square] = _mm_or_si128(queenB, _mm_cmpeq_epi8(code, _mm_set1_epi8(B_ROOK)));
+            knightW[square] = _mm_cmpeq_epi8(code, _mm_set1_epi8(W_KNIGHT));
+            knightB[square] = _mm_cmpeq_epi8(code, _mm_set1_epi8(B_KNIGHT));
+        }
+
+        __m128i materialSum[4] = {zero, zero, zero, zero};
+        for (int code = W_PAWN; code <= B_KING; code++) {
+            if (tables.materialByCode[code] == 0) continue;
+            __m128i count = zero;
+            for (int square = 0; square < 64; square++) {
+                count = _mm_sub_epi8(count, _mm_cmpeq_epi8(codes[square], _mm_set1_epi8(static_cast<char>(code))));
+            }
+            __m128i value = _mm_set1_epi32(tables.materialByCode[code]);
+            __m128i counts[4] = {count, _mm_srli_si128(count, 4), _mm_srli_si128(count, 8), _mm_srli_si128(count, 12)};
+            for (int part = 0; part < 4; part++) {
+                materialSum[part] = _mm_add_epi32(materialSum[part], _mm_mullo_epi32(_mm_cvtepu8_epi32(counts[part]), value));
+            }
+        }
+
+        __m128i pieceSquareLow = zero, pieceSquareHigh = zero;
+        for (int square = 0; square < 64; square++) {
+            __m128i low = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.pieceSquareLow[square])),
+                                           codes[square]);
+            __m128i high = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.pieceSquareHigh[square])),
+                                            codes[square]);
+            pieceSquareLow = _mm_add_epi16(pieceSquareLow, _mm_unpacklo_epi8(low, high));
+            pieceSquareHigh = _mm_add_epi16(pieceSquareHigh, _mm_unpackhi_epi8(low, high));
+        }
+
+        __m128i mobilityLow = zero, mobilityHigh = zero;
+        for (int d = 0; d < 16; d++) {
+            __m128i difference = zero;
+            if (d < 8) {
+                const RayOrder& order = fill.rays[d];
+                const __m128i* slidersW = d < 4 ? diagonalW : straightW;
+                const __m128i* slidersB = d < 4 ? diagonalB : straightB;
+                __m128i rayW = zero, rayB = zero;
+                for (int i = 0; i < 64; i++) {
+                    int square = order.square[i];
+                    if (order.lineStart[i]) {
+                        rayW = rayB = zero;
+                        continue;
+                    }
+                    int previous = order.square[i - 1];
+                    rayW = _mm_or_si128(slidersW[previous], _mm_and_si128(rayW, empty[previous]));
+                    rayB = _mm_or_si128(slidersB[previous], _mm_and_si128(rayB, empty[previous]));
+                    difference = _mm_sub_epi8(difference, _mm_and_si128(rayW, notWhite[square]));
+                    difference = _mm_add_epi8(difference, _mm_and_si128(rayB, notBlack[square]));
+                }
+            } else {
+                const KnightStep& step = fill.knights[d - 8];
+                for (int i = 0; i < step.count; i++) {
+                    difference = _mm_sub_epi8(difference, _mm_and_si128(knightW[step.from[i]], notWhite[step.to[i]]));
+                    difference = _mm_add_epi8(difference, _mm_and_si128(knightB[step.from[i]], notBlack[step.to[i]]));
+                }
+            }
+            __m128i sign = _mm_cmpgt_epi8(zero, difference);
+            mobilityLow = _mm_add_epi16(mobilityLow, _mm_unpacklo_epi8(difference, sign));
+            mobilityHigh = _mm_add_epi16(mobilityHigh, _mm_unpackhi_epi8(difference, sign));
+        }
+
+        for (int part = 0; part < 4; part++) {
+            __m128i pieceSquares = part < 2 ? pieceSquareLow : pieceSquareHigh;
+            __m128i mobilities = part < 2 ? mobilityLow : mobilityHigh;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(material + index + part * 4), materialSum[part]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pieceSquare + index + part * 4),
+                             _mm_cvtepi16_epi32(part % 2 ? _mm_srli_si128(pieceSquares, 8) : pieceSquares));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(mobility + index + part * 4),
+                             _mm_cvtepi16_epi32(part % 2 ? _mm_srli_si128(mobilities, 8) : mobilities));
+        }
+    }
+}
+
+TARGET_AVX2 void evaluateAvx2(const PositionBatch& batch, const BatchTables& tables, int32_t* material,
+                              int32_t* pieceSquare, int32_t* mobility) {
+    const FillGeometry& fill = fillGeometry();
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(-1);
+
+    for (size_t index = 0; index < batch.size(); index += 32) {
+        __m256i codes[64], empty[64], notWhite[64], notBlack[64];
+        __m256i diagonalW[64], diagonalB[64], straightW[64], straightB[64], knightW[64], knightB[64];
+        for (int square = 0; square < 64; square++) {
+            __m256i code = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.square(square) + index));
+            __m256i black = _mm256_cmpgt_epi8(code, _mm256_set1_epi8(6));
+            codes[square] = code;
+            empty[square] = _mm256_cmpeq_epi8(code, zero);
+            notBlack[square] = _mm256_xor_si256(black, ones);
+            notWhite[square] = _mm256_or_si256(empty[square], black);
+            __m256i queenW = _mm256_cmpeq_epi8(code, _mm256_set1_epi8(W_QUEEN));
+            __m256i queenB = _mm256_cmpeq_epi8(code, _mm256_set1_epi8(B_QUEEN));
+            diagonalW[square] = _mm256_or_si256(queenW, _mm256_cmpeq_epi8(code, _mm256_set1_epi8(W_BISHOP)));
+            diagonalB[square] = _mm256_or_si256(queenB, _mm256_cmpeq_epi8(code, _mm256_set1_epi8(B_BISHOP)));
+            straightW[square] = _mm256_or_si256(queenW, _mm256_cmpeq_epi8(code, _mm256_set1_epi8(W_ROOK)));
+            straightB[square] = _mm256_or_si256(queenB, _mm256_cmpeq_epi8(code, _mm256_set1_epi8(B_ROOK)));
+            knightW[square] = _mm256_cmpeq_epi8(code, _mm256_set1_epi8(W_KNIGHT));
+            knightB[square] = _mm256_cmpeq_epi8(code, _mm256_set1_epi8(B_KNIGHT));
+        }
+
+        __m256i materialSum[4] = {zero, zero, zero, zero};
+        for (int code = W_PAWN; code <= B_KING; code++) {
+            if (tables.materialByCode[code] == 0) continue;
+            __m256i count = zero;
+            for (int square = 0; square < 64; square++) {
+                count = _mm256_sub_epi8(count, _mm256_cmpeq_epi8(codes[square], _mm256_set1_epi8(static_cast<char>(code))));
+            }
+            __m256i value = _mm256_set1_epi32(tables.materialByCode[code]);
+            for (int part = 0; part < 4; part++) {
+                __m128i half = part < 2 ? _mm256_castsi256_si128(count) : _mm256_extracti128_si256(count, 1);
+                __m256i counts = _mm256_cvtepu8_epi32(part % 2 ? _mm_srli_si128(half, 8) : half);
+                materialSum[part] = _mm256_add_epi32(materialSum[part], _mm256_mullo_epi32(counts, value));
+            }
+        }
+
+        // unpacklo/unpackhi work within 128-bit halves: the low sums hold
+        // positions 0-7 and 16-23, the high sums 8-15 and 24-31
+        __m256i pieceSquareLow = zero, pieceSquareHigh = zero;
+        for (int square = 0; square < 64; square++) {
+            __m256i lowTable = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.pieceSquareLow[square])));
+            __m256i highTable = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.pieceSquareHigh[square])));
+            __m256i low = _mm256_shuffle_epi8(lowTable, codes[square]);
+            __m256i high = _mm256_shuffle_epi8(highTable, codes[square]);
+            pieceSquareLow = _mm256_add_epi16(pieceSquareLow, _mm256_unpacklo_epi8(low, high));
+            pieceSquareHigh = _mm256_add_epi16(pieceSquareHigh, _mm256_unpackhi_epi8(low, high));
+        }
+
+        __m256i mobilityLow = zero, mobilityHigh = zero;
+        for (int d = 0; d < 16; d++) {
+            __m256i difference = zero;
+            if (d < 8) {
+                const RayOrder& order = fill.rays[d];
+                const __m256i* slidersW = d < 4 ? diagonalW : straightW;
+                const __m256i* slidersB = d < 4 ? diagonalB : straightB;
+                __m256i rayW = zero, rayB = zero;
+                for (int i = 0; i < 64; i++) {
+                    int square = order.square[i];
+                    if (order.lineStart[i]) {
+                        rayW = rayB = zero;
+                        continue;
+                    }
+                    int previous = order.square[i - 1];
+                    rayW = _mm256_or_si256(slidersW[previous], _mm256_and_si256(rayW, empty[previous]));
+                    rayB = _mm256_or_si256(slidersB[previous], _mm256_and_si256(rayB, empty[previous]));
+                    difference = _mm256_sub_epi8(difference, _mm256_and_si256(rayW, notWhite[square]));
+                    difference = _mm256_add_epi8(difference, _mm256_and_si256(rayB, notBlack[square]));
+                }
+            } else {
+                const KnightStep& step = fill.knights[d - 8];
+                for (int i = 0; i < step.count; i++) {
+                    difference = _mm256_sub_epi8(difference,
+                                                 _mm256_and_si256(knightW[step.from[i]], notWhite[step.to[i]]));
+                    difference = _mm256_add_epi8(difference,
+                                                 _mm256_and_si256(knightB[step.from[i]], notBlack[step.to[i]]));
+                }
+            }
+            __m256i sign = _mm256_cmpgt_epi8(zero, difference);
+            mobilityLow = _mm256_add_epi16(mobilityLow, _mm256_unpacklo_epi8(difference, sign));
+            mobilityHigh = _mm256_add_epi16(mobilityHigh, _mm256_unpackhi_epi8(difference, sign));
+        }
+
+        for (int part = 0; part < 4; part++) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(material + index + part * 8), materialSum[part]);
+            // Part p covers positions 8p to 8p+7
+            __m256i pieceSquares = part % 2 ? pieceSquareHigh : pieceSquareLow;
+            __m256i mobilities = part % 2 ? mobilityHigh : mobilityLow;
+            __m128i pieceSquareHalf = part < 2 ? _mm256_castsi256_si128(pieceSquares) : _mm256_extracti128_si256(pieceSquares, 1);
+            __m128i mobilityHalf = part < 2 ? _mm256_castsi256_si128(mobilities) : _mm256_extracti128_si256(mobilities, 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pieceSquare + index + part * 8),
+                                _mm256_cvtepi16_epi32(pieceSquareHalf));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(mobility + index + part * 8),
+                                _mm256_cvtepi16_epi32(mobilityHalf));
+        }
+    }
+}
+
+#endif // CHESS_X86_64
+
+} // namespace
+
+PositionBatch::PositionBatch(size_t capacity) : count(0) {
+    stride = (capacity + LANES - 1) / LANES * LANES;
+    squares.assign(64 * stride, EMPTY);
+}
+
+bool PositionBatch::add(const Board& board) {
+    if (count == stride) return false;
+    for (int square = 0; square < 64; square++) {
+        squares[square * stride + count] = static_cast<uint8_t>(board.getPiece(square));
+    }
+    count++;
+    return true;
+}
+
+void PositionBatch::clear() {
+    std::fill(squares.begin(), squares.end(), static_cast<uint8_t>(EMPTY));
+    count = 0;
+}
+
+BatchEvaluator::BatchEvaluator(const EvalWeights& weights) : weights(weights), vectorExact(true) {
+    for (int code = 0; code < 16; code++) {
+        int sign = (code >= B_PAWN && code <= B_KING) ? -1 : 1;
+        PieceType type = (code >= W_PAWN && code <= B_KING) ? pieceType(static_cast<Piece>(code)) : NO_TYPE;
+        tables.materialByCode[code] = sign * weights.pieceValue[type];
+        for (int square = 0; square < 64; square++) {
+            int value = sign * weights.pieceSquare[type][sign > 0 ? square : square ^ 56];
+            tables.pieceSquareLow[square][code] = static_cast<uint8_t>(value & 0xFF);
+            tables.pieceSquareHigh[square][code] = static_cast<uint8_t>((value >> 8) & 0xFF);
+            // 64 squares of int16 sums must not overflow
+            if (value > 511 || value < -511) vectorExact = false;
+        }
+    }
+}
+
+void BatchEvaluator::evaluate(const PositionBatch& batch, BatchFeatures& features, SimdLevel level) const {
+    // The vector paths write whole blocks, up to the padded capacity
+    features.material.resize(batch.capacity());
+    features.pieceSquare.resize(batch.capacity());
+    features.mobility.resize(batch.capacity());
+    if (level > supportedSimdLevel()) level = supportedSimdLevel();
+    if (!vectorExact) level = SIMD_SCALAR;
+
+#ifdef CHESS_X86_64
+    if (level == SIMD_AVX2) {
+        evaluateAvx2(batch, tables, features.material.data(), features.pieceSquare.data(),
+                     features.mobility.data());
+    } else if (level == SIMD_SSE41) {
+        evaluateSse41(batch, tables, features.material.data(), features.pieceSquare.data(),
+                      features.mobility.data());
+    }
+#endif
+    if (level == SIMD_SCALAR) {
+        for (size_t index = 0; index < batch.size(); index++) {
+            EvalFeatures position = computeFeatures(
+                [&](int square) { return static_cast<int>(batch.square(square)[index]); }, weights);
+            features.material[index] = position.material;
+            features.pieceSquare[index] = position.pieceSquare;
+            features.mobility[index] = position.mobility;
+        }
+    }
+
+    features.material.resize(batch.size());
+    features.pieceSquare.resize(batch.size());
+    features.mobility.resize(batch.size());
+}
+
+EvalFeatures BatchEvaluator::reference(const Board& board, const EvalWeights& weights) {
+    return computeFeatures([&](int square) { return static_cast<int>(board.getPiece(square)); }, weights);
+}
@@ -0,0 +1,85 @@
+#ifndef BATCH_EVALUATION_H
+#define BATCH_EVALUATION_H
+
+#include "Board.h"
+#include "Evaluation.h"
+#include "Simd.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Evaluation features of one position, from white's point of view
+struct EvalFeatures {
+    int material;
+    int pieceSquare;
+    int mobility;       // Knight, bishop, rook and queen target squares, white minus black
+};
+
+// Positions stored square-major (struct of arrays): the piece codes of one
+// square for every position in the batch are contiguous, so SIMD lanes
+// hold different positions and neighbouring squares are plain loads.
+class PositionBatch {
+public:
+    static const size_t LANES = 32;    // Capacity is padded to a multiple of this
+
+private:
+    std::vector<uint8_t> squares;      // squares[square * stride + index]
+    size_t stride;
+    size_t count;
+
+public:
+    explicit PositionBatch(size_t capacity);
+
+    // Returns false when the batch is full
+    bool add(const Board& board);
+    void clear();
+
+    size_t size() const { return count; }
+    size_t capacity() const { return stride; }
+    const uint8_t* square(int square) const { return &squares[square * stride]; }
+};
+
+// Features of a whole batch, one array per feature
+struct BatchFeatures {
+    std::vector<int32_t> material;
+    std::vector<int32_t> pieceSquare;
+    std::vector<int32_t> mobility;
+
+    EvalFeatures at(size_t index) const {
+        EvalFeatures features = {material[index], pieceSquare[index], mobility[index]};
+        return features;
+    }
+};
+
+// Weights rearranged for the vector kernels: signed by color (black
+// negative), indexed by piece code, black piece-square entries mirrored.
+// Piece-square values are split into bytes for 16-entry shuffle lookups.
+struct BatchTables {
+    int32_t materialByCode[16];
+    uint8_t pieceSquareLow[64][16];
+    uint8_t pieceSquareHigh[64][16];
+};
+
+// Computes the same features as the scalar reference, bit for bit, with
+// the widest instruction set the CPU supports. Piece-square weights beyond
+// +-511 could overflow the vector sums, so those use the scalar path.
+class BatchEvaluator {
+private:
+    EvalWeights weights;
+    BatchTables tables;
+    bool vectorExact;
+
+public:
+    explicit BatchEvaluator(const EvalWeights& weights = EvalWeights::defaults());
+
+    // level is capped at what the CPU supports
+    void evaluate(const PositionBatch& batch, BatchFeatures& features, SimdLevel level) const;
+    void evaluate(const PositionBatch& batch, BatchFeatures& features) const {
+        evaluate(batch, features, supportedSimdLevel());
+    }
+
+    // Scalar reference implementation of the features
+    static EvalFeatures reference(const Board& board, const EvalWeights& weights = EvalWeights::defaults());
+};
+
+#endif // BATCH_EVALUATION_H
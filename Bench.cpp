@@ -0,0 +1,736 @@
+/**
+ * chess_bench - microbenchmarks for the core Board operations
+ *
+ * Usage:
+ *   chess_bench [google benchmark flags]    e.g. --benchmark_format=json
+ *   chess_bench bench [depth] [engine opts]  Fixed-depth search signature,
+ *                                           e.g. bench 6 pvs=0,aspiration=0
+ *
+ * Every benchmark runs once per position in the table below; the label
+ * names the position so JSON output from two commits can be diffed.
+ * "bench" searches each position to a fixed depth with a fresh engine and
+ * prints the total node count. The count only changes when move
+ * generation, ordering or search behaviour changes.
+ *
+ * Every form of global operator new is counted; benchmarks report heap
+ * allocations per iteration as the "allocs" counter.
+ */
+
+#include "../include/AnalysisTree.h"
+#include "../include/BatchEvaluation.h"
+#include "../include/Board.h"
+#include "../include/Game.h"
+#include "../include/MateSolver.h"
+#include "../include/Nnue.h"
+#include "../include/Search.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount(0);
+
+void* allocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(align, (size + align - 1) / align * align + (size ? 0 : align));
+#endif
+}
+
+// Not inlined: GCC would otherwise see free() applied to the result of a
+// new expression and warn (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+NOINLINE void release(void* block) {
+    std::free(block);
+}
+
+NOINLINE void releaseAligned(void* block) {
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    std::free(block);
+#endif
+}
+
+} // namespace
+
+// The whole replaceable set, so that every form of new is counted and
+// every delete frees with the matching function
+void* operator new(std::size_t size) {
+    void* block = allocate(size);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* block = allocateAligned(size, alignment);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* block) noexcept { release(block); }
+void operator delete[](void* block) noexcept { release(block); }
+void operator delete(void* block, std::size_t) noexcept { release(block); }
+void operator delete[](void* block, std::size_t) noexcept { release(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { release(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { release(block); }
+void operator delete(void* block, std::align_val_t) noexcept { releaseAligned(block); }
+void operator delete[](void* block, std::align_val_t) noexcept { releaseAligned(block); }
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept { releaseAligned(block); }
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept { releaseAligned(block); }
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(block); }
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(block); }
+
+namespace {
+
+// Records heap allocations made between construction and report()
+class AllocationCounter {
+private:
+    uint64_t start;
+
+public:
+    AllocationCounter() : start(allocationCount.load()) {}
+
+    void report(benchmark::State& state) const {
+        double allocations = static_cast<double>(allocationCount.load() - start);
+        state.counters["allocs"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    }
+};
+
+struct BenchPosition {
+    const char* name;
+    const char* fen;
+};
+
+const BenchPosition POSITIONS[] = {
+    {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+    {"italian", "r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4"},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+    {"middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"},
+    {"fools_mate", "rnb1kbnr/pppp1ppp/8/4p3/5PPq/8/PPPPP2P/RNBQKBNR w KQkq - 1 3"},
+    {"rook_ending", "8/8/4k3/3r4/8/3K4/3R4/8 w - - 0 60"},
+    {"pawn_ending", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+};
+
+const int POSITION_COUNT = sizeof(POSITIONS) / sizeof(POSITIONS[0]);
+
+Board loadPosition(benchmark::State& state) {
+    const BenchPosition& position = POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    Board board;
+    board.loadFromFEN(position.fen);
+    return board;
+}
+
+void BM_GenerateLegalMoves(benchmark::State& state) {
+    Board board = loadPosition(state);
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        std::vector<Move> moves = board.generateLegalMoves();
+        benchmark::DoNotOptimize(moves.data());
+    }
+    allocations.report(state);
+}
+
+void BM_GenerateMoveList(benchmark::State& state) {
+    Board board = loadPosition(state);
+    MoveList moves;
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        board.generateLegalMoves(moves);
+        benchmark::DoNotOptimize(moves.begin());
+    }
+    allocations.report(state);
+}
+
+void BM_MakeUndoMove(benchmark::State& state) {
+    Board board = loadPosition(state);
+    board.reserveHistory(16);
+    std::vector<Move> moves = board.generateLegalMoves();
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (const Move& move : moves) {
+            board.makeMove(move);
+            board.undoMove();
+        }
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+
+void BM_ApplyUndoMove(benchmark::State& state) {
+    Board board = loadPosition(state);
+    board.reserveHistory(16);
+    std::vector<Move> moves = board.generateLegalMoves();
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (const Move& move : moves) {
+            board.applyMove(move);
+            board.undoMove();
+        }
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+
+void BM_IsSquareAttacked(benchmark::State& state) {
+    Board board = loadPosition(state);
+    Color opponent = board.getCurrentPlayer() == WHITE ? BLACK : WHITE;
+    for (auto _ : state) {
+        int attacked = 0;
+        for (int square = 0; square < 64; square++) {
+            attacked += board.isSquareAttacked(square, opponent);
+        }
+        benchmark::DoNotOptimize(attacked);
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+
+void BM_IsInCheck(benchmark::State& state) {
+    Board board = loadPosition(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(board.isInCheck(board.getCurrentPlayer()));
+    }
+}
+
+void BM_IsCheckmate(benchmark::State& state) {
+    Board board = loadPosition(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(board.isCheckmate());
+    }
+}
+
+void BM_HasLegalMove(benchmark::State& state) {
+    Board board = loadPosition(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(board.hasLegalMove());
+    }
+}
+
+void BM_LoadFromFEN(benchmark::State& state) {
+    Board board = loadPosition(state);
+    std::string fen = POSITIONS[state.range(0)].fen;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(board.loadFromFEN(fen));
+    }
+}
+
+void BM_ToFEN(benchmark::State& state) {
+    Board board = loadPosition(state);
+    for (auto _ : state) {
+        std::string fen = board.toFEN();
+        benchmark::DoNotOptimize(fen.data());
+    }
+}
+
+void BM_ParseMove(benchmark::State& state) {
+    loadPosition(state);
+    Game game;
+    game.newGame(POSITIONS[state.range(0)].fen);
+    std::vector<std::string> moveStrings = game.getLegalMovesAsStrings();
+    for (auto _ : state) {
+        for (const std::string& text : moveStrings) {
+            benchmark::DoNotOptimize(game.parseMove(text));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moveStrings.size());
+}
+
+// The standard perft reference positions with their published leaf counts,
+// then positions in check whose counts were cross-checked against the full
+// generator
+struct PerftPosition {
+    const char* name;
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+const PerftPosition PERFT_POSITIONS[] = {
+    {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862},
+    {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 4, 43238},
+    {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467},
+    {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379},
+    // Side to move in check: single check, double check, en passant evasion
+    {"check", "r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 3 2", 4, 563603},
+    {"double_check", "4k3/8/8/8/1b6/8/8/R3K2r w Q - 0 1", 5, 338557},
+    {"ep_check", "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 3", 5, 36744},
+};
+
+const int PERFT_POSITION_COUNT = sizeof(PERFT_POSITIONS) / sizeof(PERFT_POSITIONS[0]);
+
+// items/s is leaf nodes per second
+void BM_Perft(benchmark::State& state) {
+    const PerftPosition& position = PERFT_POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    Board board;
+    board.loadFromFEN(position.fen);
+    board.reserveHistory(16);
+
+    uint64_t nodes = 0;
+    for (auto _ : state) {
+        uint64_t count = board.perft(position.depth);
+        if (count != position.nodes) {
+            state.SkipWithError("perft count mismatch");
+            break;
+        }
+        nodes += count;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(nodes));
+}
+
+// Repeated fixed-depth searches with one engine. The TT, killers and
+// history are cleared before each, so every iteration does the same work;
+// buffers grown by the warm-up search are kept, so allocations only come
+// from the result's PV. BM_SearchReuse measures a warm TT.
+void BM_Search(benchmark::State& state) {
+    Board board = loadPosition(state);
+    Search search;
+    SearchLimits limits;
+    limits.depth = 3;
+    search.think(board, limits);
+
+    uint64_t nodes = 0;
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        search.newGame();
+        nodes += search.think(board, limits).nodes;
+    }
+    allocations.report(state);
+    state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kAvgIterations);
+}
+
+// MultiPV overhead: range(0) is the position, range(1) the number of lines
+void BM_MultiPv(benchmark::State& state) {
+    Board board = loadPosition(state);
+    Search search;
+    SearchLimits limits;
+    limits.depth = 3;
+    limits.multiPv = static_cast<int>(state.range(1));
+
+    uint64_t nodes = 0;
+    for (auto _ : state) {
+        search.newGame();
+        nodes += search.think(board, limits).nodes;
+    }
+    state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kAvgIterations);
+}
+
+// Time to depth for the next move after the expected reply: range(0) is the
+// position, range(1) is 1 to keep the TT, killers and history of the first
+// search and 0 to start the second search cold
+void BM_SearchReuse(benchmark::State& state) {
+    Board board = loadPosition(state);
+    bool reuse = state.range(1) != 0;
+    Search search;
+    SearchLimits limits;
+    limits.depth = 4;
+
+    uint64_t nodes = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        search.newGame();
+        SearchResult first = search.think(board, limits);
+        Board next = board;
+        for (size_t i = 0; i < first.pv.size() && i < 2; i++) next.makeMove(first.pv[i]);
+        if (!reuse) search.newGame();
+        state.ResumeTiming();
+
+        nodes += search.think(next, limits).nodes;
+    }
+    state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kAvgIterations);
+}
+
+// Time to depth 5 by search window: range(1) is 0 for plain alpha-beta, 1
+// for PVS and 2 for PVS with aspiration windows
+void BM_SearchWindow(benchmark::State& state) {
+    Board board = loadPosition(state);
+    EngineConfig config;
+    config.usePvs = state.range(1) >= 1;
+    config.useAspiration = state.range(1) >= 2;
+    Search search(config);
+    SearchLimits limits;
+    limits.depth = 5;
+
+    uint64_t nodes = 0;
+    for (auto _ : state) {
+        search.newGame();
+        nodes += search.think(board, limits).nodes;
+    }
+    state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kAvgIterations);
+}
+
+// Forced mates by checks, taken from engine self-play games and confirmed
+// by the full search
+struct MatePosition {
+    const char* name;
+    const char* fen;
+    int mateIn;
+};
+
+const MatePosition MATE_POSITIONS[] = {
+    {"legal_m2", "r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", 2},
+    {"rooks_m3", "3R4/1p3ppk/8/1R6/5Pr1/8/r1P2P1P/7K b - - 0 27", 3},
+    {"back_rank_m3", "6k1/5ppp/8/8/1r2P2P/6P1/R2r1P2/K7 w - - 0 30", 3},
+    {"queen_m4", "2QR4/k5p1/p7/5P2/2p1p1B1/P6P/1q5P/6K1 w - - 1 32", 4},
+    {"king_hunt_m4", "2k5/Q4prp/8/1P4q1/2b5/P1N3P1/2P4P/4RRK1 w - - 2 27", 4},
+    {"king_hunt_m5", "2k2b1r/5ppp/1R6/R7/8/4B3/p2K1PBP/8 w - - 3 30", 5},
+};
+
+const int MATE_POSITION_COUNT = sizeof(MATE_POSITIONS) / sizeof(MATE_POSITIONS[0]);
+
+// Time to prove the mate with df-pn, range(0) indexing MATE_POSITIONS
+void BM_MateSolve(benchmark::State& state) {
+    const MatePosition& position = MATE_POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    Board board;
+    board.loadFromFEN(position.fen);
+    MateSolver solver;
+    MateLimits limits;
+    limits.maxMoves = position.mateIn;
+
+    uint64_t nodes = 0;
+    for (auto _ : state) {
+        solver.clear();
+        MateResult result = solver.solve(board, limits);
+        if (result.status != MATE_PROVEN || result.mateIn != position.mateIn) {
+            state.SkipWithError("mate not found");
+            break;
+        }
+        nodes += result.nodes;
+    }
+    state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kAvgIterations);
+}
+
+// The same mates found by the alpha-beta search; it stops at the first
+// iteration that sees the mate
+void BM_MateSearch(benchmark::State& state) {
+    const MatePosition& position = MATE_POSITIONS[state.range(0)];
+    state.SetLabel(position.name);
+    Board board;
+    board.loadFromFEN(position.fen);
+    Search search;
+    SearchLimits limits;
+    limits.depth = 2 * position.mateIn + 1;
+
+    uint64_t nodes = 0;
+    for (auto _ : state) {
+        search.newGame();
+        SearchResult result = search.think(board, limits);
+        if (result.score != Search::MATE_SCORE - (2 * position.mateIn - 1)) {
+            state.SkipWithError("mate not found");
+            break;
+        }
+        nodes += result.nodes;
+    }
+    state.counters["nodes"] = benchmark::Counter(static_cast<double>(nodes), benchmark::Counter::kAvgIterations);
+}
+
+// Features of 4096 positions per iteration; range(0) is the SimdLevel and
+// items/s is positions per second
+void BM_BatchEvaluate(benchmark::State& state) {
+    SimdLevel level = static_cast<SimdLevel>(state.range(0));
+    state.SetLabel(simdLevelName(level));
+    if (level > supportedSimdLevel()) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+
+    const size_t count = 4096;
+    PositionBatch batch(count);
+    for (size_t i = 0; i < count; i++) {
+        Board board;
+        board.loadFromFEN(POSITIONS[i % POSITION_COUNT].fen);
+        batch.add(board);
+    }
+    BatchEvaluator evaluator;
+    BatchFeatures features;
+    for (auto _ : state) {
+        evaluator.evaluate(batch, features, level);
+        benchmark::DoNotOptimize(features.mobility.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+
+// Random weights time the same as trained ones; the file is written once
+// to the temp directory and mapped like a real network
+const NnueNetwork& benchNetwork() {
+    static NnueNetwork network;
+    if (!network.isLoaded()) {
+        std::string filename = (std::filesystem::temp_directory_path() / "chess_bench.nnue").string();
+        if (!NnueNetwork::writeRandom(filename, 1) || !network.load(filename)) {
+            std::cerr << "cannot create " << filename << "\n";
+            std::exit(1);
+        }
+    }
+    return network;
+}
+
+// range(0) is the SimdLevel; items/s is evaluations per second
+void BM_NnueEvaluate(benchmark::State& state) {
+    SimdLevel level = static_cast<SimdLevel>(state.range(0));
+    state.SetLabel(simdLevelName(level));
+    if (level > supportedSimdLevel()) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+
+    const NnueNetwork& network = benchNetwork();
+    std::vector<Board> boards(POSITION_COUNT);
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        boards[i].loadFromFEN(POSITIONS[i].fen);
+        boards[i].setNetwork(&network);
+    }
+    for (auto _ : state) {
+        for (const Board& board : boards) {
+            benchmark::DoNotOptimize(network.evaluate(board.getAccumulator(), board.getCurrentPlayer(), level));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * boards.size()));
+}
+
+// Like BM_ApplyUndoMove with a network attached: the difference is the
+// cost of the incremental accumulator update
+void BM_NnueApplyUndoMove(benchmark::State& state) {
+    Board board = loadPosition(state);
+    board.setNetwork(&benchNetwork());
+    board.reserveHistory(16);
+    std::vector<Move> moves = board.generateLegalMoves();
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        for (const Move& move : moves) {
+            board.applyMove(move);
+            board.undoMove();
+        }
+    }
+    allocations.report(state);
+    state.SetItemsProcessed(state.iterations() * moves.size());
+}
+
+// Both perspectives from scratch, what every move would cost without
+// incremental updates
+void BM_NnueRefresh(benchmark::State& state) {
+    Board board = loadPosition(state);
+    const NnueNetwork& network = benchNetwork();
+    NnueAccumulator accumulator;
+    for (auto _ : state) {
+        network.refresh(board.getState().board, WHITE, accumulator);
+        network.refresh(board.getState().board, BLACK, accumulator);
+        benchmark::DoNotOptimize(accumulator.values);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Every line from the start position to depth 5: 5072213 nodes, built
+// once and shared by the tree benchmarks
+void expandTree(AnalysisTree& tree, int depth) {
+    if (depth == 0) return;
+    MoveList moves;
+    tree.getBoard().generateLegalMoves(moves);
+    uint32_t node = tree.current();
+    for (const Move& move : moves) {
+        tree.goTo(tree.addMove(move));
+        expandTree(tree, depth - 1);
+        tree.goTo(node);
+    }
+}
+
+AnalysisTree& benchTree() {
+    static AnalysisTree tree;
+    if (tree.nodeCount() == 1) {
+        tree.reserve(5072213);
+        expandTree(tree, 5);
+    }
+    return tree;
+}
+
+// The same random nodes for every run
+std::vector<uint32_t> treeTargets(const AnalysisTree& tree, size_t count) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(tree.nodeCount() - 1));
+    std::vector<uint32_t> targets(count);
+    for (uint32_t& target : targets) target = pick(rng);
+    return targets;
+}
+
+void treeCounters(benchmark::State& state, const AnalysisTree& tree) {
+    state.counters["nodes"] = static_cast<double>(tree.nodeCount());
+    state.counters["positions"] = static_cast<double>(tree.positionCount());
+    state.counters["bytes/node"] = static_cast<double>(tree.memoryUsage()) / tree.nodeCount();
+}
+
+// goTo between tree nodes; items/s is navigations per second. range(0) 0
+// jumps between random nodes, 1 flips 32 times between a random node and
+// its next sibling, i.e. between two sidelines, before the next jump.
+void BM_TreeNavigate(benchmark::State& state) {
+    AnalysisTree& tree = benchTree();
+    std::vector<uint32_t> targets = treeTargets(tree, 4096);
+    if (state.range(0) == 1) {
+        for (size_t i = 0; i < targets.size(); i += 64) {
+            uint32_t sibling = tree.nextSibling(targets[i]);
+            if (sibling == AnalysisTree::NO_NODE) sibling = tree.firstChild(tree.parent(targets[i]));
+            for (size_t j = 1; j < 64; j++) targets[i + j] = j % 2 ? sibling : targets[i];
+        }
+    }
+    state.SetLabel(state.range(0) == 0 ? "random" : "sibling");
+    for (auto _ : state) {
+        for (uint32_t target : targets) tree.goTo(target);
+        benchmark::DoNotOptimize(tree.getBoard().getHash());
+    }
+    treeCounters(state, tree);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * targets.size()));
+}
+
+// What reaching the same random nodes costs with Game alone: a new game
+// and a replay of the line from the start
+void BM_TreeReplay(benchmark::State& state) {
+    AnalysisTree& tree = benchTree();
+    std::vector<std::vector<std::string>> lines;
+    for (uint32_t target : treeTargets(tree, 4096)) {
+        std::vector<std::string> line;
+        for (uint32_t node = target; node != AnalysisTree::ROOT; node = tree.parent(node)) {
+            line.insert(line.begin(), tree.moveText(node));
+        }
+        lines.push_back(line);
+    }
+    Game game;
+    for (auto _ : state) {
+        for (const std::vector<std::string>& line : lines) {
+            game.newGame();
+            game.replayMoves(line);
+        }
+        benchmark::DoNotOptimize(game.getBoard().getHash());
+    }
+    treeCounters(state, tree);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * lines.size()));
+}
+
+void allPositions(benchmark::internal::Benchmark* benchmark) {
+    benchmark->DenseRange(0, POSITION_COUNT - 1);
+}
+
+BENCHMARK(BM_GenerateLegalMoves)->Apply(allPositions);
+BENCHMARK(BM_GenerateMoveList)->Apply(allPositions);
+BENCHMARK(BM_MakeUndoMove)->Apply(allPositions);
+BENCHMARK(BM_ApplyUndoMove)->Apply(allPositions);
+BENCHMARK(BM_IsSquareAttacked)->Apply(allPositions);
+BENCHMARK(BM_IsInCheck)->Apply(allPositions);
+BENCHMARK(BM_IsCheckmate)->Apply(allPositions);
+BENCHMARK(BM_HasLegalMove)->Apply(allPositions);
+BENCHMARK(BM_LoadFromFEN)->Apply(allPositions);
+BENCHMARK(BM_ToFEN)->Apply(allPositions);
+BENCHMARK(BM_ParseMove)->Apply(allPositions);
+BENCHMARK(BM_Perft)->DenseRange(0, PERFT_POSITION_COUNT - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Search)->Apply(allPositions)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MultiPv)->ArgsProduct({{0, 1, 3}, {1, 2, 3, 4, 5}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BatchEvaluate)->DenseRange(SIMD_SCALAR, SIMD_AVX2);
+BENCHMARK(BM_NnueEvaluate)->DenseRange(SIMD_SCALAR, SIMD_AVX2);
+BENCHMARK(BM_NnueApplyUndoMove)->Apply(allPositions);
+BENCHMARK(BM_NnueRefresh)->Apply(allPositions);
+BENCHMARK(BM_SearchReuse)->ArgsProduct({{0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MateSolve)->DenseRange(0, MATE_POSITION_COUNT - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MateSearch)->DenseRange(0, MATE_POSITION_COUNT - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TreeNavigate)->DenseRange(0, 1);
+BENCHMARK(BM_TreeReplay);
+BENCHMARK(BM_SearchWindow)->ArgsProduct({{0, 1, 2, 3, 5, 6}, {0, 1, 2}})->Unit(benchmark::kMillisecond);
+
+int runSignature(int depth, const EngineConfig& config) {
+    SearchLimits limits;
+    limits.depth = depth;
+
+    uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const BenchPosition& position : POSITIONS) {
+        Board board;
+        board.loadFromFEN(position.fen);
+        Search search(config);
+        SearchResult result = search.think(board, limits);
+        std::cout << position.name << ": " << result.nodes << " nodes, best ";
+        if (result.bestMove.from == -1) {
+            std::cout << "(none)\n";
+        } else {
+            std::cout << board.squareToAlgebraic(result.bestMove.from)
+                      << board.squareToAlgebraic(result.bestMove.to) << "\n";
+        }
+        totalNodes += result.nodes;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "===========================\n";
+    std::cout << "Depth       : " << depth << "\n";
+    std::cout << "Total time  : " << static_cast<int>(seconds * 1000) << " ms\n";
+    std::cout << "Nodes       : " << totalNodes << "\n";
+    std::cout << "Nodes/second: " << static_cast<uint64_t>(totalNodes / (seconds > 0 ? seconds : 1)) << "\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::strcmp(argv[1], "bench") == 0) {
+        int depth = argc >= 3 ? std::atoi(argv[2]) : 4;
+        EngineConfig config;
+        std::string item;
+        if (argc >= 4 && !config.setOptions(argv[3], item)) {
+            std::cerr << "Unknown engine option: " << item << "\n";
+            return 1;
+        }
+        return runSignature(depth > 0 ? depth : 4, config);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
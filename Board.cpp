@@ -1,9 +1,13 @@
 #include "../include/Board.h"
+#include "../include/Nnue.h"
+#include "../include/SearchStats.h"
+#include "../include/Zobrist.h"
 #include <iostream>
 #include <algorithm>
+#include <cassert>
 #include <sstream>
 
-Board::Board() {
+Board::Board() : network(nullptr), statusValid(false) {
     initializeStartingPosition();
 }
 
@@ -39,19 +43,146 @@ void Board::initializeStartingPosition() {
     state.enPassantSquare = -1;
     state.halfMoveClock = 0;
     state.fullMoveNumber = 1;
+    state.hash = computeHash();
 
     history.clear();
+    refreshAccumulator();
+    invalidateStatus();
 }
 
-bool Board::isSquareEmpty(int square) const {
-    return square >= 0 && square < 64 && state.board[square] == EMPTY;
+bool Board::loadFromFEN(const std::string& fen) {
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    int halfMoves = 0, fullMoves = 1;
+    if (!(stream >> placement >> side)) {
+        return false;
+    }
+    if (!(stream >> castling)) castling = "-";
+    if (!(stream >> enPassant)) enPassant = "-";
+    if (!(stream >> halfMoves)) halfMoves = 0;
+    if (!(stream >> fullMoves)) fullMoves = 1;
+
+    GameState parsed;
+    for (int i = 0; i < 64; i++) {
+        parsed.board[i] = EMPTY;
+    }
+
+    // Piece placement, rank 8 first
+    int rank = 7, file = 0;
+    int kings[2] = {0, 0};
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) return false;
+            rank--;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) return false;
+        } else {
+            Piece piece = EMPTY;
+            switch (c) {
+                case 'P': piece = W_PAWN; break;
+                case 'N': piece = W_KNIGHT; break;
+                case 'B': piece = W_BISHOP; break;
+                case 'R': piece = W_ROOK; break;
+                case 'Q': piece = W_QUEEN; break;
+                case 'K': piece = W_KING; break;
+                case 'p': piece = B_PAWN; break;
+                case 'n': piece = B_KNIGHT; break;
+                case 'b': piece = B_BISHOP; break;
+                case 'r': piece = B_ROOK; break;
+                case 'q': piece = B_QUEEN; break;
+                case 'k': piece = B_KING; break;
+                default: return false;
+            }
+            if (file > 7) return false;
+            // Move generation relies on both: pawn targets are not
+            // bounds-checked, and every position has a king to attack
+            if ((piece == W_PAWN || piece == B_PAWN) && (rank == 0 || rank == 7)) return false;
+            if (piece == W_KING) kings[WHITE]++;
+            if (piece == B_KING) kings[BLACK]++;
+            parsed.board[getSquare(rank, file)] = piece;
+            file++;
+        }
+    }
+    if (rank != 0 || file != 8) return false;
+    if (kings[WHITE] != 1 || kings[BLACK] != 1) return false;
+
+    if (side == "w") parsed.currentPlayer = WHITE;
+    else if (side == "b") parsed.currentPlayer = BLACK;
+    else return false;
+
+    parsed.canCastleKingSide[WHITE] = castling.find('K') != std::string::npos;
+    parsed.canCastleQueenSide[WHITE] = castling.find('Q') != std::string::npos;
+    parsed.canCastleKingSide[BLACK] = castling.find('k') != std::string::npos;
+    parsed.canCastleQueenSide[BLACK] = castling.find('q') != std::string::npos;
+
+    parsed.enPassantSquare = (enPassant == "-") ? -1 : algebraicToSquare(enPassant);
+    parsed.halfMoveClock = halfMoves;
+    parsed.fullMoveNumber = fullMoves;
+
+    state = parsed;
+    state.hash = computeHash();
+    history.clear();
+    refreshAccumulator();
+    invalidateStatus();
+    return true;
+}
+
+void Board::reserveHistory(size_t plies) {
+    history.reserve(plies);
+    if (network) accumulators.reserve(plies + 1);
+}
+
+void Board::setNetwork(const NnueNetwork* nnue) {
+    network = nnue;
+    if (network) accumulators.reserve(history.capacity() + 1);
+    refreshAccumulator();
 }
 
-bool Board::isSquareOccupiedBy(int square, Color color) const {
-    if (square < 0 || square >= 64) return false;
-    Piece piece = state.board[square];
-    if (piece == EMPTY) return false;
-    return getPieceColor(piece) == color;
+void Board::refreshAccumulator() {
+    accumulators.clear();
+    if (!network) return;
+    accumulators.emplace_back();
+    network->refresh(state.board, WHITE, accumulators.back());
+    network->refresh(state.board, BLACK, accumulators.back());
+}
+
+std::string Board::toFEN() const {
+    static const char symbols[] = ".PNBRQKpnbrqk";
+    std::string fen;
+
+    for (int rank = 7; rank >= 0; rank--) {
+        int emptyCount = 0;
+        for (int file = 0; file < 8; file++) {
+            Piece piece = state.board[getSquare(rank, file)];
+            if (piece == EMPTY) {
+                emptyCount++;
+                continue;
+            }
+            if (emptyCount > 0) {
+                fen += (char)('0' + emptyCount);
+                emptyCount = 0;
+            }
+            fen += symbols[piece];
+        }
+        if (emptyCount > 0) fen += (char)('0' + emptyCount);
+        if (rank > 0) fen += '/';
+    }
+
+    fen += (state.currentPlayer == WHITE) ? " w " : " b ";
+
+    std::string castling;
+    if (state.canCastleKingSide[WHITE]) castling += 'K';
+    if (state.canCastleQueenSide[WHITE]) castling += 'Q';
+    if (state.canCastleKingSide[BLACK]) castling += 'k';
+    if (state.canCastleQueenSide[BLACK]) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+
+    fen += " ";
+    fen += (state.enPassantSquare == -1) ? "-" : squareToAlgebraic(state.enPassantSquare);
+    fen += " " + std::to_string(state.halfMoveClock) + " " + std::to_string(state.fullMoveNumber);
+    return fen;
 }
 
 Color Board::getPieceColor(Piece piece) const {
@@ -60,361 +191,578 @@ Color Board::getPieceColor(Piece piece) const {
     return WHITE; // Should not happen for valid pieces
 }
 
-bool Board::isInBounds(int rank, int file) const {
-    return rank >= 0 && rank < 8 && file >= 0 && file < 8;
-}
-
 int Board::getSquare(int rank, int file) const {
     return rank * 8 + file;
 }
 
-void Board::getRankFile(int square, int& rank, int& file) const {
-    rank = square / 8;
-    file = square % 8;
+namespace {
+
+// Per-color constants, so the generator and make move specialised on the
+// side to move have no color branches in their loops
+template <Color Us> struct Side;
+
+template <> struct Side<WHITE> {
+    static constexpr Color THEM = BLACK;
+    static constexpr int FORWARD = 8;           // Square offset of a pawn push
+    static constexpr int START_RANK = 1;        // Pawns may push twice from here
+    static constexpr int PROMOTION_RANK = 6;    // Pawns promote moving from here
+    static constexpr int KING_START = 4;
+    static constexpr Piece PAWN = W_PAWN, KNIGHT = W_KNIGHT, BISHOP = W_BISHOP;
+    static constexpr Piece ROOK = W_ROOK, QUEEN = W_QUEEN, KING = W_KING;
+    static bool owns(Piece piece) { return piece >= W_PAWN && piece <= W_KING; }
+};
+
+template <> struct Side<BLACK> {
+    static constexpr Color THEM = WHITE;
+    static constexpr int FORWARD = -8;
+    static constexpr int START_RANK = 6;
+    static constexpr int PROMOTION_RANK = 1;
+    static constexpr int KING_START = 60;
+    static constexpr Piece PAWN = B_PAWN, KNIGHT = B_KNIGHT, BISHOP = B_BISHOP;
+    static constexpr Piece ROOK = B_ROOK, QUEEN = B_QUEEN, KING = B_KING;
+    static bool owns(Piece piece) { return piece >= B_PAWN; }
+};
+
+// Steps as {rank, file} deltas
+constexpr int KNIGHT_STEPS[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+constexpr int KING_STEPS[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+constexpr int BISHOP_RAYS[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+constexpr int ROOK_RAYS[4][2] = {{-1, 0}, {0, -1}, {0, 1}, {1, 0}};
+
+inline bool onBoard(int rank, int file) {
+    return static_cast<unsigned>(rank) < 8 && static_cast<unsigned>(file) < 8;
 }
 
-bool Board::isPathClear(int from, int to) const {
-    int fromRank, fromFile, toRank, toFile;
-    getRankFile(from, fromRank, fromFile);
-    getRankFile(to, toRank, toFile);
-
-    int rankDir = (toRank > fromRank) ? 1 : (toRank < fromRank) ? -1 : 0;
-    int fileDir = (toFile > fromFile) ? 1 : (toFile < fromFile) ? -1 : 0;
-
-    int currentRank = fromRank + rankDir;
-    int currentFile = fromFile + fileDir;
-
-    while (currentRank != toRank || currentFile != toFile) {
-        if (!isSquareEmpty(getSquare(currentRank, currentFile))) {
-            return false;
+// Moves of one piece are pushed ray by ray; keep them ordered by target
+// square so the list order, and with it the search, matches a square scan
+void sortByTarget(Move* first, Move* last) {
+    for (Move* current = first + 1; current < last; current++) {
+        Move move = *current;
+        Move* slot = current;
+        while (slot > first && (slot - 1)->to > move.to) {
+            *slot = *(slot - 1);
+            slot--;
         }
-        currentRank += rankDir;
-        currentFile += fileDir;
+        *slot = move;
     }
+}
 
-    return true;
+} // namespace
+
+int Board::findKing(Color color) const {
+    Piece king = (color == WHITE) ? W_KING : B_KING;
+    for (int i = 0; i < 64; i++) {
+        if (state.board[i] == king) return i;
+    }
+    return -1;
 }
 
-bool Board::isValidPawnMove(const Move& move) const {
-    int fromRank, fromFile, toRank, toFile;
-    getRankFile(move.from, fromRank, fromFile);
-    getRankFile(move.to, toRank, toFile);
+template <Color Them>
+bool Board::attackedBy(int square) const {
+    typedef Side<Them> S;
+    int rank = square / 8, file = square % 8;
 
-    Color color = getPieceColor(move.piece);
-    int direction = (color == WHITE) ? 1 : -1;
-    int startRank = (color == WHITE) ? 1 : 6;
+    // A pawn attacks the square from one rank behind it, seen from Them
+    int pawnRank = rank - S::FORWARD / 8;
+    if (onBoard(pawnRank, 0)) {
+        if (file > 0 && state.board[pawnRank * 8 + file - 1] == S::PAWN) return true;
+        if (file < 7 && state.board[pawnRank * 8 + file + 1] == S::PAWN) return true;
+    }
 
-    // Forward move
-    if (fromFile == toFile) {
-        if (toRank == fromRank + direction && isSquareEmpty(move.to)) {
-            return true; // Single step
-        }
-        if (fromRank == startRank && toRank == fromRank + 2 * direction && 
-            isSquareEmpty(move.to) && isSquareEmpty(getSquare(fromRank + direction, fromFile))) {
-            return true; // Double step
-        }
+    for (const auto& step : KNIGHT_STEPS) {
+        int r = rank + step[0], f = file + step[1];
+        if (onBoard(r, f) && state.board[r * 8 + f] == S::KNIGHT) return true;
     }
-    // Diagonal capture
-    else if (abs(fromFile - toFile) == 1 && toRank == fromRank + direction) {
-        if (!isSquareEmpty(move.to) && getPieceColor(state.board[move.to]) != color) {
-            return true; // Regular capture
+    for (const auto& step : KING_STEPS) {
+        int r = rank + step[0], f = file + step[1];
+        if (onBoard(r, f) && state.board[r * 8 + f] == S::KING) return true;
+    }
+
+    for (const auto& ray : ROOK_RAYS) {
+        for (int r = rank + ray[0], f = file + ray[1]; onBoard(r, f); r += ray[0], f += ray[1]) {
+            Piece piece = state.board[r * 8 + f];
+            if (piece == EMPTY) continue;
+            if (piece == S::ROOK || piece == S::QUEEN) return true;
+            break;
         }
-        if (move.to == state.enPassantSquare) {
-            return true; // En passant
+    }
+    for (const auto& ray : BISHOP_RAYS) {
+        for (int r = rank + ray[0], f = file + ray[1]; onBoard(r, f); r += ray[0], f += ray[1]) {
+            Piece piece = state.board[r * 8 + f];
+            if (piece == EMPTY) continue;
+            if (piece == S::BISHOP || piece == S::QUEEN) return true;
+            break;
         }
     }
-
     return false;
 }
 
-bool Board::isValidKnightMove(const Move& move) const {
-    int fromRank, fromFile, toRank, toFile;
-    getRankFile(move.from, fromRank, fromFile);
-    getRankFile(move.to, toRank, toFile);
+bool Board::isSquareAttacked(int square, Color attackingColor) const {
+    return attackingColor == WHITE ? attackedBy<WHITE>(square) : attackedBy<BLACK>(square);
+}
 
-    int rankDiff = abs(toRank - fromRank);
-    int fileDiff = abs(toFile - fromFile);
+bool Board::isInCheck(Color color) const {
+    int kingSquare = findKing(color);
+    return kingSquare != -1 && isSquareAttacked(kingSquare, (Color)(1 - color));
+}
 
-    return (rankDiff == 2 && fileDiff == 1) || (rankDiff == 1 && fileDiff == 2);
+template <Color Us>
+bool Board::wouldBeInCheck(const Move& move, int kingSquare) const {
+#ifdef CHESS_SEARCH_STATS
+    uint64_t untracked = 0;
+    SearchStats* stats = SearchStats::current();
+    StatTimer timer(stats != nullptr ? stats->legalityNanos : untracked);
+#endif
+    if (kingSquare == -1) return false;
+
+    // Make the move on the squares it touches, test, and put them back
+    Piece* squares = const_cast<Board*>(this)->state.board;
+    int capturedPawnSquare = move.isEnPassant ? move.to - Side<Us>::FORWARD : move.to;
+    Piece capturedPawn = squares[capturedPawnSquare];
+    Piece target = squares[move.to];
+    squares[capturedPawnSquare] = EMPTY;
+    squares[move.to] = move.piece;
+    squares[move.from] = EMPTY;
+
+    int king = (move.piece == Side<Us>::KING) ? move.to : kingSquare;
+    bool inCheck = attackedBy<Side<Us>::THEM>(king);
+
+    squares[move.from] = move.piece;
+    squares[move.to] = target;
+    squares[capturedPawnSquare] = capturedPawn;
+    return inCheck;
 }
 
-bool Board::isValidBishopMove(const Move& move) const {
-    int fromRank, fromFile, toRank, toFile;
-    getRankFile(move.from, fromRank, fromFile);
-    getRankFile(move.to, toRank, toFile);
+template <Color Us>
+bool Board::givesCheckFor(const Move& move, int enemyKing) const {
+    if (enemyKing == -1) return false;
+
+    // As in wouldBeInCheck, with the piece that lands and the castling rook
+    Piece* squares = const_cast<Board*>(this)->state.board;
+    int capturedPawnSquare = move.isEnPassant ? move.to - Side<Us>::FORWARD : move.to;
+    int rookFrom = move.to > move.from ? move.from + 3 : move.from - 4;
+    int rookTo = move.to > move.from ? move.from + 1 : move.from - 1;
+    Piece capturedPawn = squares[capturedPawnSquare];
+    Piece target = squares[move.to];
+    squares[capturedPawnSquare] = EMPTY;
+    squares[move.to] = move.promotion != EMPTY ? move.promotion : move.piece;
+    squares[move.from] = EMPTY;
+    if (move.isCastling) {
+        squares[rookFrom] = EMPTY;
+        squares[rookTo] = Side<Us>::ROOK;
+    }
 
-    int rankDiff = abs(toRank - fromRank);
-    int fileDiff = abs(toFile - fromFile);
+    bool check = attackedBy<Us>(enemyKing);
 
-    return rankDiff == fileDiff && rankDiff > 0 && isPathClear(move.from, move.to);
+    if (move.isCastling) {
+        squares[rookTo] = EMPTY;
+        squares[rookFrom] = Side<Us>::ROOK;
+    }
+    squares[move.from] = move.piece;
+    squares[move.to] = target;
+    squares[capturedPawnSquare] = capturedPawn;
+    return check;
 }
 
-bool Board::isValidRookMove(const Move& move) const {
-    int fromRank, fromFile, toRank, toFile;
-    getRankFile(move.from, fromRank, fromFile);
-    getRankFile(move.to, toRank, toFile);
-
-    return (fromRank == toRank || fromFile == toFile) && 
-           fromRank != toRank || fromFile != toFile &&
-           isPathClear(move.from, move.to);
+bool Board::givesCheck(const Move& move) const {
+    if (state.currentPlayer == WHITE) return givesCheckFor<WHITE>(move, findKing(BLACK));
+    return givesCheckFor<BLACK>(move, findKing(WHITE));
 }
 
-bool Board::isValidQueenMove(const Move& move) const {
-    return isValidRookMove(move) || isValidBishopMove(move);
-}
+template <Color Us>
+Board::GenContext Board::makeContext() const {
+    typedef Side<Us> S;
+    typedef Side<S::THEM> T;
+    GenContext context;
+    context.kingSquare = findKing(Us);
+    context.pinned = 0;
+    context.targets = ~0ULL;
+    context.inCheck = false;
+    if (context.kingSquare == -1) return context;
+
+    int rank = context.kingSquare / 8, file = context.kingSquare % 8;
+    int checkers = 0;
+    uint64_t evasionTargets = 0;
+
+    // Pawn and knight checks can only be answered by taking the checker
+    int pawnRank = rank + S::FORWARD / 8;
+    if (onBoard(pawnRank, 0)) {
+        for (int f = file - 1; f <= file + 1; f += 2) {
+            if (onBoard(pawnRank, f) && state.board[pawnRank * 8 + f] == T::PAWN) {
+                checkers++;
+                evasionTargets |= 1ULL << (pawnRank * 8 + f);
+            }
+        }
+    }
+    for (const auto& step : KNIGHT_STEPS) {
+        int r = rank + step[0], f = file + step[1];
+        if (onBoard(r, f) && state.board[r * 8 + f] == T::KNIGHT) {
+            checkers++;
+            evasionTargets |= 1ULL << (r * 8 + f);
+        }
+    }
 
-bool Board::isValidKingMove(const Move& move) const {
-    int fromRank, fromFile, toRank, toFile;
-    getRankFile(move.from, fromRank, fromFile);
-    getRankFile(move.to, toRank, toFile);
+    // Along each ray: a slider behind no piece gives check, and behind one
+    // of our pieces pins it
+    for (int i = 0; i < 8; i++) {
+        const int* ray = (i < 4) ? BISHOP_RAYS[i] : ROOK_RAYS[i - 4];
+        Piece slider = (i < 4) ? T::BISHOP : T::ROOK;
+        uint64_t path = 0;
+        int blocker = -1;
+        for (int r = rank + ray[0], f = file + ray[1]; onBoard(r, f); r += ray[0], f += ray[1]) {
+            int square = r * 8 + f;
+            Piece piece = state.board[square];
+            path |= 1ULL << square;
+            if (piece == EMPTY) continue;
+            if (piece == slider || piece == T::QUEEN) {
+                if (blocker == -1) {
+                    checkers++;
+                    evasionTargets |= path;
+                } else {
+                    context.pinned |= 1ULL << blocker;
+                }
+            } else if (blocker == -1 && S::owns(piece)) {
+                blocker = square;
+                continue;
+            }
+            break;
+        }
+    }
 
-    int rankDiff = abs(toRank - fromRank);
-    int fileDiff = abs(toFile - fromFile);
+    // In check, other pieces must take the checker or block its ray; against
+    // a double check only the king can move
+    if (checkers > 0) {
+        context.inCheck = true;
+        context.targets = (checkers == 1) ? evasionTargets : 0;
+    }
+    return context;
+}
 
-    // Regular king move
-    if (rankDiff <= 1 && fileDiff <= 1 && (rankDiff > 0 || fileDiff > 0)) {
-        return true;
+template <Color Us>
+bool Board::addIfLegal(const Move& move, const GenContext& context, MoveList& moves) const {
+    if (move.piece != Side<Us>::KING) {
+        // Outside the targets only an en passant capture of a target pawn helps
+        if (!(context.targets >> move.to & 1) &&
+            !(move.isEnPassant && (context.targets >> (move.to - Side<Us>::FORWARD) & 1))) {
+            return false;
+        }
+        // An unpinned piece can only expose the king by en passant, which
+        // removes a second piece from the board
+        if (!(context.pinned >> move.from & 1) && !move.isEnPassant) {
+            moves.push_back(move);
+            return true;
+        }
     }
+    if (wouldBeInCheck<Us>(move, context.kingSquare)) return false;
+    moves.push_back(move);
+    return true;
+}
+
+template <Color Us, GenType Type>
+bool Board::generatePieceMovesFor(int from, const GenContext& context, MoveList& moves,
+                                  bool stopAtFirst) const {
+    typedef Side<Us> S;
+    const bool captures = Type != GEN_QUIETS;
+    const bool quiets = Type != GEN_CAPTURES;
+
+    Piece piece = state.board[from];
+    if (!S::owns(piece)) return false;
+    int rank = from / 8, file = from % 8;
+    int first = moves.size();
+
+    if (piece == S::PAWN) {
+        // Every promotion counts as a capture, so quiets never promote
+        bool promotes = rank == S::PROMOTION_RANK;
+        const Piece promotions[4] = {S::QUEEN, S::ROOK, S::BISHOP, S::KNIGHT};
+
+        // Targets in ascending square order: the capture left of the push
+        // is the lower square for white and the higher one for black
+        int pawnTargets[3] = {from + S::FORWARD - 1, from + S::FORWARD, from + S::FORWARD + 1};
+        int targetFiles[3] = {file - 1, file, file + 1};
+        for (int i = 0; i < 3; i++) {
+            int to = pawnTargets[i];
+            if (!onBoard(0, targetFiles[i])) continue;
 
-    // Castling
-    if (move.isCastling && rankDiff == 0 && fileDiff == 2) {
-        Color color = getPieceColor(move.piece);
-        int rank = (color == WHITE) ? 0 : 7;
+            Move move(from, to, piece);
+            move.captured = state.board[to];
+            if (i == 1) {
+                if (move.captured != EMPTY) continue;
+                if (!promotes && !quiets) continue;
+            } else {
+                if (!captures) continue;
+                if (to == state.enPassantSquare && move.captured == EMPTY) {
+                    move.isEnPassant = true;
+                } else if (move.captured == EMPTY || S::owns(move.captured)) {
+                    continue;
+                }
+            }
+
+            if (promotes) {
+                if (!captures) continue;
+                for (Piece promotion : promotions) {
+                    move.promotion = promotion;
+                    if (addIfLegal<Us>(move, context, moves) && stopAtFirst) return true;
+                }
+            } else if (addIfLegal<Us>(move, context, moves) && stopAtFirst) {
+                return true;
+            }
+        }
 
-        if (fromRank != rank || isInCheck(color)) return false;
+        int doubleTo = from + 2 * S::FORWARD;
+        if (quiets && rank == S::START_RANK && state.board[from + S::FORWARD] == EMPTY &&
+            state.board[doubleTo] == EMPTY) {
+            Move move(from, doubleTo, piece);
+            move.isDoublePawnPush = true;
+            if (addIfLegal<Us>(move, context, moves) && stopAtFirst) return true;
+        }
+    } else if (piece == S::KNIGHT || piece == S::KING) {
+        const int (*steps)[2] = (piece == S::KNIGHT) ? KNIGHT_STEPS : KING_STEPS;
+        for (int i = 0; i < 8; i++) {
+            int r = rank + steps[i][0], f = file + steps[i][1];
+            if (!onBoard(r, f)) continue;
+            Move move(from, r * 8 + f, piece);
+            move.captured = state.board[move.to];
+            if (move.captured == EMPTY ? !quiets : (!captures || S::owns(move.captured))) continue;
+            if (addIfLegal<Us>(move, context, moves) && stopAtFirst) return true;
+        }
 
-        // King side castling
-        if (toFile == 6 && state.canCastleKingSide[color]) {
-            return isPathClear(move.from, move.to) && 
-                   !isSquareAttacked(getSquare(rank, 5), (Color)(1 - color)) &&
-                   !isSquareAttacked(getSquare(rank, 6), (Color)(1 - color));
+        // Castling: rights, an empty path and no attacked square on the way
+        if (piece == S::KING && quiets && from == S::KING_START && !context.inCheck &&
+            (state.canCastleKingSide[Us] || state.canCastleQueenSide[Us])) {
+            const Piece* squares = state.board;
+            if (state.canCastleKingSide[Us] && squares[from + 3] == S::ROOK &&
+                squares[from + 1] == EMPTY && squares[from + 2] == EMPTY &&
+                !attackedBy<S::THEM>(from + 1) && !attackedBy<S::THEM>(from + 2)) {
+                Move move(from, from + 2, piece);
+                move.isCastling = true;
+                moves.push_back(move);
+                if (stopAtFirst) return true;
+            }
+            if (state.canCastleQueenSide[Us] && squares[from - 4] == S::ROOK &&
+                squares[from - 1] == EMPTY && squares[from - 2] == EMPTY && squares[from - 3] == EMPTY &&
+                !attackedBy<S::THEM>(from - 1) && !attackedBy<S::THEM>(from - 2)) {
+                Move move(from, from - 2, piece);
+                move.isCastling = true;
+                moves.push_back(move);
+                if (stopAtFirst) return true;
+            }
         }
-        // Queen side castling  
-        if (toFile == 2 && state.canCastleQueenSide[color]) {
-            return isPathClear(move.from, getSquare(rank, 1)) &&
-                   !isSquareAttacked(getSquare(rank, 3), (Color)(1 - color)) &&
-                   !isSquareAttacked(getSquare(rank, 2), (Color)(1 - color));
+    } else {
+        bool diagonal = piece == S::BISHOP || piece == S::QUEEN;
+        bool straight = piece == S::ROOK || piece == S::QUEEN;
+        for (int i = 0; i < 8; i++) {
+            const int* ray = (i < 4) ? BISHOP_RAYS[i] : ROOK_RAYS[i - 4];
+            if (!((i < 4) ? diagonal : straight)) continue;
+            for (int r = rank + ray[0], f = file + ray[1]; onBoard(r, f); r += ray[0], f += ray[1]) {
+                Move move(from, r * 8 + f, piece);
+                move.captured = state.board[move.to];
+                if (move.captured == EMPTY) {
+                    if (quiets && addIfLegal<Us>(move, context, moves) && stopAtFirst) return true;
+                    continue;
+                }
+                if (captures && !S::owns(move.captured) &&
+                    addIfLegal<Us>(move, context, moves) && stopAtFirst) {
+                    return true;
+                }
+                break;
+            }
         }
     }
 
+    sortByTarget(moves.begin() + first, moves.end());
     return false;
 }
 
-bool Board::isSquareAttacked(int square, Color attackingColor) const {
+template <Color Us, GenType Type>
+void Board::generateMovesFor(MoveList& moves) const {
+    GenContext context = makeContext<Us>();
     for (int from = 0; from < 64; from++) {
-        Piece piece = state.board[from];
-        if (piece == EMPTY || getPieceColor(piece) != attackingColor) continue;
-
-        Move testMove(from, square, piece);
+        // In double check nothing but the king can move
+        if (context.targets == 0 && from != context.kingSquare) continue;
+        generatePieceMovesFor<Us, Type>(from, context, moves, false);
+    }
 
-        switch (piece) {
-            case W_PAWN:
-            case B_PAWN:
-                if (isValidPawnMove(testMove)) return true;
-                break;
-            case W_KNIGHT:
-            case B_KNIGHT:
-                if (isValidKnightMove(testMove)) return true;
-                break;
-            case W_BISHOP:
-            case B_BISHOP:
-                if (isValidBishopMove(testMove)) return true;
-                break;
-            case W_ROOK:
-            case B_ROOK:
-                if (isValidRookMove(testMove)) return true;
-                break;
-            case W_QUEEN:
-            case B_QUEEN:
-                if (isValidQueenMove(testMove)) return true;
-                break;
-            case W_KING:
-            case B_KING:
-                // King attacks like regular move but without castling
-                {
-                    int fromRank, fromFile, toRank, toFile;
-                    getRankFile(from, fromRank, fromFile);
-                    getRankFile(square, toRank, toFile);
-                    int rankDiff = abs(toRank - fromRank);
-                    int fileDiff = abs(toFile - fromFile);
-                    if (rankDiff <= 1 && fileDiff <= 1 && (rankDiff > 0 || fileDiff > 0)) {
-                        return true;
-                    }
-                }
-                break;
+    // Checks are generated as every move and filtered; the test is cheap
+    // next to making the move
+    if (Type == GEN_CHECKS) {
+        int enemyKing = findKing(Side<Us>::THEM);
+        int kept = 0;
+        for (const Move& move : moves) {
+            if (givesCheckFor<Us>(move, enemyKing)) moves[kept++] = move;
         }
+        moves.truncate(kept);
     }
-    return false;
 }
 
-bool Board::isInCheck(Color color) const {
-    // Find king
-    Piece king = (color == WHITE) ? W_KING : B_KING;
-    for (int i = 0; i < 64; i++) {
-        if (state.board[i] == king) {
-            return isSquareAttacked(i, (Color)(1 - color));
+template <Color Us>
+bool Board::hasLegalMoveFor() const {
+    // King moves first: they are the likeliest escape and cheap to try
+    GenContext context = makeContext<Us>();
+    MoveList found;
+    if (context.kingSquare != -1 && generatePieceMovesFor<Us, GEN_ALL>(context.kingSquare, context, found, true)) {
+        return true;
+    }
+    if (context.targets == 0) return false;
+    for (int from = 0; from < 64; from++) {
+        if (from != context.kingSquare && generatePieceMovesFor<Us, GEN_ALL>(from, context, found, true)) {
+            return true;
         }
     }
     return false;
 }
 
-bool Board::wouldBeInCheck(const Move& move, Color color) const {
-    // Make temporary move
-    GameState originalState = state;
-    const_cast<Board*>(this)->state.board[move.to] = move.piece;
-    const_cast<Board*>(this)->state.board[move.from] = EMPTY;
-
-    bool inCheck = isInCheck(color);
-
-    // Restore state
-    const_cast<Board*>(this)->state = originalState;
-
-    return inCheck;
-}
-
 std::vector<Move> Board::generateLegalMoves() const {
-    std::vector<Move> moves;
-    Color currentColor = state.currentPlayer;
-
-    for (int from = 0; from < 64; from++) {
-        Piece piece = state.board[from];
-        if (piece == EMPTY || getPieceColor(piece) != currentColor) continue;
-
-        for (int to = 0; to < 64; to++) {
-            if (from == to) continue;
+    MoveList list;
+    generateLegalMoves(list);
+    return std::vector<Move>(list.begin(), list.end());
+}
 
-            Move move(from, to, piece);
-            move.captured = state.board[to];
+void Board::generateLegalMoves(MoveList& moves, GenType type) const {
+    moves.clear();
+    bool white = state.currentPlayer == WHITE;
+    switch (type) {
+        case GEN_CAPTURES:
+            white ? generateMovesFor<WHITE, GEN_CAPTURES>(moves) : generateMovesFor<BLACK, GEN_CAPTURES>(moves);
+            break;
+        case GEN_QUIETS:
+            white ? generateMovesFor<WHITE, GEN_QUIETS>(moves) : generateMovesFor<BLACK, GEN_QUIETS>(moves);
+            break;
+        case GEN_CHECKS:
+            white ? generateMovesFor<WHITE, GEN_CHECKS>(moves) : generateMovesFor<BLACK, GEN_CHECKS>(moves);
+            break;
+        default:
+            white ? generateMovesFor<WHITE, GEN_ALL>(moves) : generateMovesFor<BLACK, GEN_ALL>(moves);
+            // The full list is a free source of the legal move count
+            if (statusValid) status.legalMoveCount = moves.size();
+            break;
+    }
+}
 
-            // Skip if capturing own piece
-            if (move.captured != EMPTY && getPieceColor(move.captured) == currentColor) {
-                continue;
-            }
+bool Board::generatePieceMoves(int from, MoveList& moves, bool stopAtFirst) const {
+    if (state.currentPlayer == WHITE) {
+        return generatePieceMovesFor<WHITE, GEN_ALL>(from, makeContext<WHITE>(), moves, stopAtFirst);
+    }
+    return generatePieceMovesFor<BLACK, GEN_ALL>(from, makeContext<BLACK>(), moves, stopAtFirst);
+}
 
-            // Check basic move validity
-            bool valid = false;
-            switch (piece) {
-                case W_PAWN:
-                case B_PAWN:
-                    valid = isValidPawnMove(move);
-                    if (valid) {
-                        // Check for en passant
-                        int fromRank, fromFile, toRank, toFile;
-                        getRankFile(from, fromRank, fromFile);
-                        getRankFile(to, toRank, toFile);
-                        if (to == state.enPassantSquare) {
-                            move.isEnPassant = true;
-                        }
-                        // Check for double pawn push
-                        if (abs(toRank - fromRank) == 2) {
-                            move.isDoublePawnPush = true;
-                        }
-                        // Check for promotion
-                        if ((currentColor == WHITE && toRank == 7) || 
-                            (currentColor == BLACK && toRank == 0)) {
-                            // Generate all promotion moves
-                            Piece promotionPieces[] = {W_QUEEN, W_ROOK, W_BISHOP, W_KNIGHT};
-                            if (currentColor == BLACK) {
-                                promotionPieces[0] = B_QUEEN; promotionPieces[1] = B_ROOK;
-                                promotionPieces[2] = B_BISHOP; promotionPieces[3] = B_KNIGHT;
-                            }
-                            for (int i = 0; i < 4; i++) {
-                                Move promMove = move;
-                                promMove.promotion = promotionPieces[i];
-                                if (!wouldBeInCheck(promMove, currentColor)) {
-                                    moves.push_back(promMove);
-                                }
-                            }
-                            continue;
-                        }
-                    }
-                    break;
-                case W_KNIGHT:
-                case B_KNIGHT:
-                    valid = isValidKnightMove(move);
-                    break;
-                case W_BISHOP:
-                case B_BISHOP:
-                    valid = isValidBishopMove(move);
-                    break;
-                case W_ROOK:
-                case B_ROOK:
-                    valid = isValidRookMove(move);
-                    break;
-                case W_QUEEN:
-                case B_QUEEN:
-                    valid = isValidQueenMove(move);
-                    break;
-                case W_KING:
-                case B_KING:
-                    valid = isValidKingMove(move);
-                    // Check for castling moves
-                    int fromRank, fromFile, toRank, toFile;
-                    getRankFile(from, fromRank, fromFile);
-                    getRankFile(to, toRank, toFile);
-                    if (valid && abs(toFile - fromFile) == 2) {
-                        move.isCastling = true;
-                    }
-                    break;
-            }
+bool Board::hasLegalMove() const {
+    return state.currentPlayer == WHITE ? hasLegalMoveFor<WHITE>() : hasLegalMoveFor<BLACK>();
+}
 
-            if (valid && !wouldBeInCheck(move, currentColor)) {
-                moves.push_back(move);
-            }
+bool Board::findLegalMove(const Move& move, Move& legalMove) const {
+    // Only the piece on the from square can make the move
+    if (move.from < 0 || move.from >= 64) return false;
+    MoveList legalMoves;
+    generatePieceMoves(move.from, legalMoves, false);
+    for (const Move& candidate : legalMoves) {
+        if (candidate.matches(move)) {
+            legalMove = candidate;
+            return true;
         }
     }
-
-    return moves;
+    return false;
 }
 
 bool Board::isValidMove(const Move& move) const {
-    std::vector<Move> legalMoves = generateLegalMoves();
-    return std::find_if(legalMoves.begin(), legalMoves.end(),
-                       [&move](const Move& m) {
-                           return m.from == move.from && m.to == move.to &&
-                                  m.promotion == move.promotion;
-                       }) != legalMoves.end();
+    Move legalMove;
+    return findLegalMove(move, legalMove);
 }
 
-bool Board::makeMove(const Move& move) {
-    if (!isValidMove(move)) {
+bool Board::makeMove(const Move& requested) {
+    // Use the generated move so the special-move flags are always right
+    Move move;
+    if (!findLegalMove(requested, move)) {
         return false;
     }
 
+    applyMove(move);
+    return true;
+}
+
+void Board::applyMove(const Move& move) {
+    if (state.currentPlayer == WHITE) applyMoveFor<WHITE>(move);
+    else applyMoveFor<BLACK>(move);
+}
+
+template <Color Us>
+void Board::updateAccumulator(const Move& move) {
+    typedef Side<Us> S;
+
+    // Kings are not features, so a king move only changes the rook when
+    // castling and the captured piece
+    NnueChange added[2], removed[2];
+    int addedCount = 0, removedCount = 0;
+    if (move.piece != S::KING) {
+        removed[removedCount++] = {move.piece, move.from};
+        added[addedCount++] = {move.promotion != EMPTY ? move.promotion : move.piece, move.to};
+    }
+    if (move.isEnPassant) {
+        // Generated en passant moves leave captured empty
+        removed[removedCount++] = {Side<S::THEM>::PAWN, move.to - S::FORWARD};
+    } else if (move.captured != EMPTY) {
+        removed[removedCount++] = {move.captured, move.to};
+    }
+    if (move.isCastling) {
+        bool kingSide = move.to > move.from;
+        removed[removedCount++] = {S::ROOK, kingSide ? S::KING_START + 3 : S::KING_START - 4};
+        added[addedCount++] = {S::ROOK, kingSide ? S::KING_START + 1 : S::KING_START - 1};
+    }
+
+    accumulators.push_back(accumulators.back());
+    NnueAccumulator& accumulator = accumulators.back();
+    if (move.piece == S::KING) {
+        network->refresh(state.board, Us, accumulator);
+    } else {
+        network->update(accumulator, Us, added, addedCount, removed, removedCount);
+    }
+    network->update(accumulator, S::THEM, added, addedCount, removed, removedCount);
+}
+
+template <Color Us>
+void Board::applyMoveFor(const Move& move) {
+    typedef Side<Us> S;
+
     // Save current state to history
     history.push_back(state);
 
+    // The parts of the key that do not follow from the moved pieces are
+    // taken out here and put back once the state is updated
+    uint64_t hash = state.hash ^ castlingHash() ^ enPassantHash();
+
     // Handle special moves
     if (move.isEnPassant) {
         // Remove captured pawn
-        int capturedPawnSquare = state.enPassantSquare + ((state.currentPlayer == WHITE) ? -8 : 8);
-        state.board[capturedPawnSquare] = EMPTY;
+        state.board[move.to - S::FORWARD] = EMPTY;
+        hash ^= Zobrist::pieceKey(Side<S::THEM>::PAWN, move.to - S::FORWARD);
+    } else if (state.board[move.to] != EMPTY) {
+        hash ^= Zobrist::pieceKey(state.board[move.to], move.to);
     }
 
     if (move.isCastling) {
         // Move rook
-        int rank = (state.currentPlayer == WHITE) ? 0 : 7;
-        if (move.to % 8 == 6) { // King side
-            state.board[getSquare(rank, 5)] = state.board[getSquare(rank, 7)];
-            state.board[getSquare(rank, 7)] = EMPTY;
+        int rookFrom, rookTo;
+        if (move.to > move.from) { // King side
+            rookFrom = S::KING_START + 3;
+            rookTo = S::KING_START + 1;
         } else { // Queen side
-            state.board[getSquare(rank, 3)] = state.board[getSquare(rank, 0)];
-            state.board[getSquare(rank, 0)] = EMPTY;
+            rookFrom = S::KING_START - 4;
+            rookTo = S::KING_START - 1;
         }
+        state.board[rookTo] = S::ROOK;
+        state.board[rookFrom] = EMPTY;
+        hash ^= Zobrist::pieceKey(S::ROOK, rookFrom) ^ Zobrist::pieceKey(S::ROOK, rookTo);
     }
 
     // Make the move
-    state.board[move.to] = (move.promotion != EMPTY) ? move.promotion : move.piece;
+    Piece placed = (move.promotion != EMPTY) ? move.promotion : move.piece;
+    state.board[move.to] = placed;
     state.board[move.from] = EMPTY;
+    hash ^= Zobrist::pieceKey(move.piece, move.from) ^ Zobrist::pieceKey(placed, move.to);
 
     // Update castling rights
-    if (move.piece == W_KING || move.from == 4) {
-        state.canCastleKingSide[WHITE] = false;
-        state.canCastleQueenSide[WHITE] = false;
-    }
-    if (move.piece == B_KING || move.from == 60) {
-        state.canCastleKingSide[BLACK] = false;
-        state.canCastleQueenSide[BLACK] = false;
+    if (move.piece == S::KING || move.from == S::KING_START) {
+        state.canCastleKingSide[Us] = false;
+        state.canCastleQueenSide[Us] = false;
     }
     if (move.from == 0 || move.to == 0) state.canCastleQueenSide[WHITE] = false;
     if (move.from == 7 || move.to == 7) state.canCastleKingSide[WHITE] = false;
@@ -422,26 +770,25 @@ bool Board::makeMove(const Move& move) {
     if (move.from == 63 || move.to == 63) state.canCastleKingSide[BLACK] = false;
 
     // Update en passant
-    state.enPassantSquare = -1;
-    if (move.isDoublePawnPush) {
-        state.enPassantSquare = move.from + ((state.currentPlayer == WHITE) ? 8 : -8);
-    }
+    state.enPassantSquare = move.isDoublePawnPush ? move.from + S::FORWARD : -1;
 
     // Update move counters
-    if (move.piece == W_PAWN || move.piece == B_PAWN || move.captured != EMPTY) {
+    if (move.piece == S::PAWN || move.captured != EMPTY) {
         state.halfMoveClock = 0;
     } else {
         state.halfMoveClock++;
     }
 
-    if (state.currentPlayer == BLACK) {
+    if (Us == BLACK) {
         state.fullMoveNumber++;
     }
 
     // Switch players
-    state.currentPlayer = (Color)(1 - state.currentPlayer);
-
-    return true;
+    state.currentPlayer = S::THEM;
+    state.hash = hash ^ castlingHash() ^ enPassantHash() ^ Zobrist::sideKey();
+    assert(state.hash == computeHash());
+    if (network) updateAccumulator<Us>(move);
+    invalidateStatus();
 }
 
 bool Board::undoMove() {
@@ -449,22 +796,82 @@ bool Board::undoMove() {
 
     state = history.back();
     history.pop_back();
+    if (network) accumulators.pop_back();
+    invalidateStatus();
     return true;
 }
 
+uint64_t Board::perft(int depth) {
+    if (depth <= 0) return 1;
+
+    MoveList moves;
+    generateLegalMoves(moves);
+    if (depth == 1) return moves.size();
+
+    uint64_t nodes = 0;
+    for (const Move& move : moves) {
+        applyMove(move);
+        nodes += perft(depth - 1);
+        undoMove();
+    }
+    return nodes;
+}
+
+bool Board::isRepetition() const {
+    // Only positions since the last capture or pawn move can repeat
+    int start = static_cast<int>(history.size()) - state.halfMoveClock;
+    if (start < 0) start = 0;
+    for (int i = static_cast<int>(history.size()) - 2; i >= start; i -= 2) {
+        if (history[i].hash == state.hash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const PositionStatus& Board::getStatus() const {
+    if (statusValid) return status;
+
+    status.inCheck = isInCheck(state.currentPlayer);
+    status.hasLegalMove = hasLegalMove();
+    status.legalMoveCount = status.hasLegalMove ? -1 : 0;
+
+    // Mate and stalemate take precedence over the draw rules
+    if (!status.hasLegalMove) {
+        status.terminal = status.inCheck ? TERMINAL_CHECKMATE : TERMINAL_STALEMATE;
+    } else if (state.halfMoveClock >= 100) {
+        status.terminal = TERMINAL_FIFTY_MOVES;
+    } else if (isInsufficientMaterial()) {
+        status.terminal = TERMINAL_INSUFFICIENT_MATERIAL;
+    } else {
+        status.terminal = NOT_TERMINAL;
+    }
+    statusValid = true;
+    return status;
+}
+
+int Board::legalMoveCount() const {
+    const PositionStatus& current = getStatus();
+    if (current.legalMoveCount < 0) {
+        generateLegalMoves();
+    }
+    return status.legalMoveCount;
+}
+
 bool Board::isCheckmate() const {
-    return isInCheck(state.currentPlayer) && generateLegalMoves().empty();
+    return getStatus().terminal == TERMINAL_CHECKMATE;
 }
 
 bool Board::isStalemate() const {
-    return !isInCheck(state.currentPlayer) && generateLegalMoves().empty();
+    return getStatus().terminal == TERMINAL_STALEMATE;
 }
 
 bool Board::isDraw() const {
-    // 50-move rule
-    if (state.halfMoveClock >= 100) return true;
+    return state.halfMoveClock >= 100 || isInsufficientMaterial();
+}
 
-    // Insufficient material (simplified)
+bool Board::isInsufficientMaterial() const {
+    // Simplified: king vs king, or king and minor piece vs king
     int pieceCount = 0;
     bool hasMinor = false;
     for (int i = 0; i < 64; i++) {
@@ -476,13 +883,40 @@ bool Board::isDraw() const {
             }
         }
     }
+    return pieceCount <= 2 || (pieceCount == 3 && hasMinor);
+}
 
-    // King vs King, or King+Minor vs King
-    if (pieceCount <= 2 || (pieceCount == 3 && hasMinor)) {
-        return true;
+uint64_t Board::computeHash() const {
+    uint64_t hash = castlingHash() ^ enPassantHash();
+    for (int i = 0; i < 64; i++) {
+        if (state.board[i] != EMPTY) {
+            hash ^= Zobrist::pieceKey(state.board[i], i);
+        }
+    }
+    if (state.currentPlayer == WHITE) {
+        hash ^= Zobrist::sideKey();
     }
+    return hash;
+}
 
-    return false;
+uint64_t Board::castlingHash() const {
+    uint64_t hash = 0;
+    if (state.canCastleKingSide[WHITE]) hash ^= Zobrist::castleKey(0);
+    if (state.canCastleQueenSide[WHITE]) hash ^= Zobrist::castleKey(1);
+    if (state.canCastleKingSide[BLACK]) hash ^= Zobrist::castleKey(2);
+    if (state.canCastleQueenSide[BLACK]) hash ^= Zobrist::castleKey(3);
+    return hash;
+}
+
+// Like Polyglot, only hash the en passant file when a capture is possible
+uint64_t Board::enPassantHash() const {
+    if (state.enPassantSquare == -1) return 0;
+    int file = state.enPassantSquare % 8;
+    int pawnRank = (state.currentPlayer == WHITE) ? 4 : 3;
+    Piece pawn = (state.currentPlayer == WHITE) ? W_PAWN : B_PAWN;
+    bool capturable = (file > 0 && state.board[getSquare(pawnRank, file - 1)] == pawn) ||
+                      (file < 7 && state.board[getSquare(pawnRank, file + 1)] == pawn);
+    return capturable ? Zobrist::enPassantKey(file) : 0;
 }
 
 std::string Board::squareToAlgebraic(int square) const {
@@ -499,32 +933,27 @@ int Board::algebraicToSquare(const std::string& algebraic) const {
     return rank * 8 + file;
 }
 
-void Board::print() const {
-    std::cout << "\n  a b c d e f g h\n";
+std::string Board::render() const {
+    static const char symbols[] = ".PNBRQKpnbrqk";
+    std::string text;
+    text.reserve(256);
+    text += "\n  a b c d e f g h\n";
     for (int rank = 7; rank >= 0; rank--) {
-        std::cout << (rank + 1) << " ";
+        char row[20];
+        row[0] = row[18] = static_cast<char>('1' + rank);
+        row[1] = ' ';
         for (int file = 0; file < 8; file++) {
-            Piece piece = state.board[rank * 8 + file];
-            char symbol = ' ';
-            switch (piece) {
-                case W_PAWN: symbol = 'P'; break;
-                case W_KNIGHT: symbol = 'N'; break;
-                case W_BISHOP: symbol = 'B'; break;
-                case W_ROOK: symbol = 'R'; break;
-                case W_QUEEN: symbol = 'Q'; break;
-                case W_KING: symbol = 'K'; break;
-                case B_PAWN: symbol = 'p'; break;
-                case B_KNIGHT: symbol = 'n'; break;
-                case B_BISHOP: symbol = 'b'; break;  
-                case B_ROOK: symbol = 'r'; break;
-                case B_QUEEN: symbol = 'q'; break;
-                case B_KING: symbol = 'k'; break;
-                default: symbol = '.'; break;
-            }
-            std::cout << symbol << " ";
+            row[2 + 2 * file] = symbols[state.board[rank * 8 + file]];
+            row[3 + 2 * file] = ' ';
         }
-        std::cout << (rank + 1) << "\n";
+        row[19] = '\n';
+        text.append(row, sizeof(row));
     }
-    std::cout << "  a b c d e f g h\n";
-    std::cout << "\nTo move: " << (state.currentPlayer == WHITE ? "White" : "Black") << "\n";
+    text += "  a b c d e f g h\n";
+    text += state.currentPlayer == WHITE ? "\nTo move: White\n" : "\nTo move: Black\n";
+    return text;
+}
+
+void Board::print() const {
+    std::cout << render();
 }
@@ -2,6 +2,7 @@
 #define BOARD_H
 
 #include <cstdint>
+#include <new>
 #include <vector>
 #include <string>
 
@@ -30,6 +31,43 @@ struct Move {
     Move(int f, int t, Piece p) : from(f), to(t), piece(p), captured(EMPTY),
                                   promotion(EMPTY), isEnPassant(false), 
                                   isCastling(false), isDoublePawnPush(false) {}
+
+    // Same squares and promotion; the other fields follow from the position
+    bool matches(const Move& other) const {
+        return from == other.from && to == other.to && promotion == other.promotion;
+    }
+};
+
+// Fixed-capacity move list. It lives on the stack or in a search arena, so
+// generating into it never touches the heap. 256 covers the 218-move
+// maximum of any legal chess position.
+class MoveList {
+public:
+    static const int CAPACITY = 256;
+
+private:
+    // Raw storage: Move's constructor would otherwise fill all 256 slots
+    alignas(Move) unsigned char storage[CAPACITY * sizeof(Move)];
+    int count;
+
+    Move* data() { return reinterpret_cast<Move*>(storage); }
+    const Move* data() const { return reinterpret_cast<const Move*>(storage); }
+
+public:
+    MoveList() : count(0) {}
+
+    void push_back(const Move& move) { new (&data()[count++]) Move(move); }
+    void clear() { count = 0; }
+    void truncate(int size) { count = size; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move& operator[](int index) { return data()[index]; }
+    const Move& operator[](int index) const { return data()[index]; }
+    Move* begin() { return data(); }
+    Move* end() { return data() + count; }
+    const Move* begin() const { return data(); }
+    const Move* end() const { return data() + count; }
 };
 
 struct GameState {
@@ -40,58 +78,163 @@ struct GameState {
     int enPassantSquare;         // -1 if no en passant possible
     int halfMoveClock;
     int fullMoveNumber;
+    uint64_t hash;               // Zobrist key, see Zobrist.h
+};
+
+enum TerminalReason {
+    NOT_TERMINAL,
+    TERMINAL_CHECKMATE,
+    TERMINAL_STALEMATE,
+    TERMINAL_FIFTY_MOVES,
+    TERMINAL_INSUFFICIENT_MATERIAL
+};
+
+// Everything needed to decide whether the game is over, computed once per
+// position. Repetition is not included since it depends on the history.
+struct PositionStatus {
+    bool inCheck;
+    bool hasLegalMove;
+    int legalMoveCount;          // -1 until the full move list is generated
+    TerminalReason terminal;
+};
+
+class NnueNetwork;
+
+// Width of one perspective of the NNUE accumulator, see Nnue.h
+const int NNUE_HIDDEN = 128;
+
+// First layer of an NNUE network for one position, indexed by perspective
+struct NnueAccumulator {
+    alignas(32) int16_t values[2][NNUE_HIDDEN];
+    int kingSquare[2];          // The features of each perspective depend on its king
 };
 
+// Which legal moves to generate. Every promotion counts as a capture, so
+// captures and quiets split the full list in two. GEN_CHECKS is the moves
+// that give check, directly or by discovery.
+enum GenType { GEN_ALL, GEN_CAPTURES, GEN_QUIETS, GEN_CHECKS };
+
 class Board {
 private:
     GameState state;
     std::vector<GameState> history;
 
+    // Accumulators of the attached network, one per position like history
+    const NnueNetwork* network;
+    std::vector<NnueAccumulator> accumulators;
+
+    // Lazily computed status of the current position
+    mutable PositionStatus status;
+    mutable bool statusValid;
+
     // Helper methods
-    bool isSquareEmpty(int square) const;
-    bool isSquareOccupiedBy(int square, Color color) const;
     Color getPieceColor(Piece piece) const;
-    bool isInBounds(int rank, int file) const;
     int getSquare(int rank, int file) const;
-    void getRankFile(int square, int& rank, int& file) const;
-
-    // Move validation helpers
-    bool isValidPawnMove(const Move& move) const;
-    bool isValidKnightMove(const Move& move) const;
-    bool isValidBishopMove(const Move& move) const;
-    bool isValidRookMove(const Move& move) const;
-    bool isValidQueenMove(const Move& move) const;
-    bool isValidKingMove(const Move& move) const;
-    bool isPathClear(int from, int to) const;
+    int findKing(Color color) const;    // -1 if the color has no king
+
+    // What the moves of one position share: the king, the pieces pinned to
+    // it, and the squares other pieces may move to (only those that capture
+    // or block a single checker when in check, none in double check)
+    struct GenContext {
+        int kingSquare;
+        uint64_t pinned;
+        uint64_t targets;
+        bool inCheck;
+    };
+
+    // Move generation, specialised on the side to move and the move type
+    template <Color Us>
+    GenContext makeContext() const;
+    template <Color Us, GenType Type>
+    void generateMovesFor(MoveList& moves) const;
+    template <Color Us, GenType Type>
+    bool generatePieceMovesFor(int from, const GenContext& context, MoveList& moves, bool stopAtFirst) const;
+    template <Color Us>
+    bool addIfLegal(const Move& move, const GenContext& context, MoveList& moves) const;
+    template <Color Us>
+    bool hasLegalMoveFor() const;
+    bool findLegalMove(const Move& move, Move& legalMove) const;
+    // Appends the legal moves of the piece on from; returns true once one
+    // is found when stopAtFirst is set
+    bool generatePieceMoves(int from, MoveList& moves, bool stopAtFirst) const;
 
     // Check detection
-    bool isSquareAttacked(int square, Color attackingColor) const;
-    bool isInCheck(Color color) const;
-    bool wouldBeInCheck(const Move& move, Color color) const;
+    template <Color Them>
+    bool attackedBy(int square) const;
+    template <Color Us>
+    bool wouldBeInCheck(const Move& move, int kingSquare) const;
+    template <Color Us>
+    bool givesCheckFor(const Move& move, int enemyKing) const;
+
+    template <Color Us>
+    void applyMoveFor(const Move& move);
+
+    template <Color Us>
+    void updateAccumulator(const Move& move);
+    void refreshAccumulator();
+
+    // Hashing. Moves update the key incrementally; computeHash() builds it
+    // from scratch for loaded positions and to check the updates.
+    uint64_t computeHash() const;
+    uint64_t castlingHash() const;
+    uint64_t enPassantHash() const;
+
+    void invalidateStatus() { statusValid = false; }
+    bool isInsufficientMaterial() const;
 
 public:
     Board();
     void initializeStartingPosition();
-    void loadFromFEN(const std::string& fen);
+    // Preallocates the undo history so up to plies moves never reallocate
+    void reserveHistory(size_t plies);
+    // Fails on malformed FENs, pawns on the first or last rank, and anything
+    // but one king per side; the board is then unchanged
+    bool loadFromFEN(const std::string& fen);
     std::string toFEN() const;
 
     // Game state access
     const GameState& getState() const { return state; }
     Piece getPiece(int square) const { return state.board[square]; }
     Color getCurrentPlayer() const { return state.currentPlayer; }
+    uint64_t getHash() const { return state.hash; }
+
+    // Attaches an NNUE network, or detaches it with nullptr. While attached,
+    // applyMove updates the accumulator incrementally (refreshing only the
+    // perspective whose king moved) and undoMove restores the previous one.
+    void setNetwork(const NnueNetwork* nnue);
+    const NnueNetwork* getNetwork() const { return network; }
+    const NnueAccumulator& getAccumulator() const { return accumulators.back(); }
 
     // Move operations
     std::vector<Move> generateLegalMoves() const;
+    // Allocation-free. In check only king moves, captures of the checker and
+    // interpositions are tried.
+    void generateLegalMoves(MoveList& moves, GenType type = GEN_ALL) const;
+    bool hasLegalMove() const;   // Stops at the first legal move, king moves first
     bool isValidMove(const Move& move) const;
     bool makeMove(const Move& move);
     bool undoMove();
 
+    // Applies a move taken from generateLegalMoves() without validating it
+    void applyMove(const Move& move);
+
+    // Counts the leaf nodes of the legal move tree, for testing move generation
+    uint64_t perft(int depth);
+
     // Game status
+    bool isSquareAttacked(int square, Color attackingColor) const;
+    bool isInCheck(Color color) const;
+    // Whether a legal move of the side to move checks the opponent's king
+    bool givesCheck(const Move& move) const;
     bool isCheckmate() const;
     bool isStalemate() const;
     bool isDraw() const;
+    bool isRepetition() const;   // Current position occurred before
+    const PositionStatus& getStatus() const;
+    int legalMoveCount() const;
 
     // Display
+    std::string render() const;     // The board as print() shows it, in one string
     void print() const;
     std::string squareToAlgebraic(int square) const;
     int algebraicToSquare(const std::string& algebraic) const;
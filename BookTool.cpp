@@ -0,0 +1,163 @@
+/**
+ * chess_book - build and inspect opening books (.cbk)
+ *
+ * Usage:
+ *   chess_book build <out.cbk> <games.pgn>... [--max-ply N]
+ *   chess_book probe <book.cbk> [move...]
+ *   chess_book validate <games.pgn>... [--threads N]
+ */
+
+#include "../include/Game.h"
+#include "../include/OpeningBook.h"
+#include "../include/Pgn.h"
+#include "../include/Replay.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void printUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  chess_book build <out.cbk> <games.pgn>... [--max-ply N]\n";
+    std::cout << "  chess_book probe <book.cbk> [move...]\n";
+    std::cout << "  chess_book validate <games.pgn>... [--threads N]\n";
+}
+
+static int buildBook(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 1;
+    }
+
+    int maxPly = 30;
+    std::vector<std::string> inputs;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--max-ply" && i + 1 < argc) {
+            maxPly = std::atoi(argv[++i]);
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BookBuilder builder(maxPly);
+    for (const std::string& input : inputs) {
+        if (!builder.addPgnFile(input)) {
+            std::cerr << "Cannot read " << input << "\n";
+            return 1;
+        }
+    }
+    if (!builder.write(argv[2])) {
+        std::cerr << "Cannot write " << argv[2] << "\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Games: " << builder.getGameCount() << "\n";
+    std::cout << "Positions: " << builder.getPositionCount() << "\n";
+    std::cout << "Time: " << seconds << " s\n";
+    return 0;
+}
+
+static int probeBook(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    OpeningBook book;
+    if (!book.open(argv[2])) {
+        std::cerr << "Cannot open " << argv[2] << "\n";
+        return 1;
+    }
+
+    Game game;
+    for (int i = 3; i < argc; i++) {
+        if (!game.makeMove(argv[i])) {
+            std::cerr << "Illegal move: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    const Board& board = game.getBoard();
+    std::vector<BookEntry> entries = book.probe(board.getHash());
+    std::cout << "Book entries: " << book.size() << "\n";
+    std::cout << "Moves for this position: " << entries.size() << "\n";
+    for (const BookEntry& entry : entries) {
+        Move move;
+        if (OpeningBook::decodeMove(board, entry.move, move)) {
+            std::cout << "  " << board.squareToAlgebraic(move.from)
+                      << board.squareToAlgebraic(move.to) << "  weight " << entry.weight << "\n";
+        }
+    }
+    return 0;
+}
+
+static int validateGames(int argc, char* argv[]) {
+    int threads = 0;
+    std::vector<std::string> inputs;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    // Parse everything first so the timing covers replay only
+    std::vector<ReplayGame> games;
+    for (const std::string& input : inputs) {
+        std::ifstream file(input);
+        if (!file.is_open()) {
+            std::cerr << "Cannot read " << input << "\n";
+            return 1;
+        }
+        PgnReader reader(file);
+        PgnGame pgn;
+        while (reader.readGame(pgn)) {
+            ReplayGame game;
+            auto fen = pgn.tags.find("FEN");
+            if (fen != pgn.tags.end()) game.startFen = fen->second;
+            game.moves.swap(pgn.moves);
+            games.push_back(game);
+        }
+    }
+
+    std::vector<ReplayOutcome> outcomes;
+    ReplayReport report = GameReplayer::replayAll(games, MOVES_SAN, threads, &outcomes);
+
+    for (size_t i = 0; i < outcomes.size(); i++) {
+        if (!outcomes[i].valid) {
+            std::cout << "Game " << i + 1 << ": illegal move at ply " << outcomes[i].movesApplied + 1 << "\n";
+        }
+    }
+    std::cout << "Games: " << report.games << " (" << report.invalidGames << " invalid)\n";
+    std::cout << "Moves: " << report.moves << "\n";
+    std::cout << "Time: " << report.seconds << " s\n";
+    std::cout << "Games/s: " << static_cast<uint64_t>(report.gamesPerSecond()) << "\n";
+    std::cout << "Moves/s: " << static_cast<uint64_t>(report.movesPerSecond()) << "\n";
+    return report.invalidGames == 0 ? 0 : 2;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::string command = argv[1];
+    if (command == "build") return buildBook(argc, argv);
+    if (command == "probe") return probeBook(argc, argv);
+    if (command == "validate") return validateGames(argc, argv);
+
+    printUsage();
+    return 1;
+}
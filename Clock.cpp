@@ -0,0 +1,83 @@
+#include "../include/Clock.h"
+#include <cstdlib>
+
+bool TimeControl::parse(const std::string& text, TimeControl& control) {
+    TimeControl parsed;
+    std::string rest = text;
+
+    size_t slash = rest.find('/');
+    if (slash != std::string::npos) {
+        parsed.movesPerPeriod = std::atoi(rest.substr(0, slash).c_str());
+        if (parsed.movesPerPeriod <= 0) return false;
+        rest = rest.substr(slash + 1);
+    }
+
+    size_t plus = rest.find('+');
+    double baseSeconds = std::atof(rest.substr(0, plus).c_str());
+    double incrementSeconds = plus == std::string::npos ? 0.0 : std::atof(rest.substr(plus + 1).c_str());
+    if (baseSeconds <= 0.0 || incrementSeconds < 0.0) return false;
+
+    parsed.baseMs = static_cast<int>(baseSeconds * 1000.0 + 0.5);
+    parsed.incrementMs = static_cast<int>(incrementSeconds * 1000.0 + 0.5);
+    control = parsed;
+    return true;
+}
+
+GameClock::GameClock() : running(WHITE), isRunning(false) {
+    reset(TimeControl());
+}
+
+void GameClock::reset(const TimeControl& timeControl) {
+    control = timeControl;
+    for (int side = 0; side < 2; side++) {
+        remainingMs[side] = control.baseMs;
+        movesMade[side] = 0;
+    }
+    isRunning = false;
+}
+
+int64_t GameClock::elapsedMs() const {
+    auto elapsed = std::chrono::steady_clock::now() - turnStart;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
+void GameClock::start(Color side) {
+    running = side;
+    isRunning = enabled();
+    turnStart = std::chrono::steady_clock::now();
+}
+
+void GameClock::stop() {
+    if (!isRunning) return;
+    remainingMs[running] -= elapsedMs();
+    isRunning = false;
+}
+
+bool GameClock::punch() {
+    if (!isRunning) return true;
+
+    Color side = running;
+    stop();
+    bool inTime = remainingMs[side] >= 0;
+
+    remainingMs[side] += control.incrementMs;
+    movesMade[side]++;
+    if (control.movesPerPeriod > 0 && movesMade[side] % control.movesPerPeriod == 0) {
+        remainingMs[side] += control.baseMs;
+    }
+
+    start(side == WHITE ? BLACK : WHITE);
+    return inTime;
+}
+
+int64_t GameClock::remaining(Color side) const {
+    if (isRunning && running == side) {
+        return remainingMs[side] - elapsedMs();
+    }
+    return remainingMs[side];
+}
+
+int GameClock::movesToGo(Color side) const {
+    if (control.movesPerPeriod == 0) return 0;
+    return control.movesPerPeriod - movesMade[side] % control.movesPerPeriod;
+}
@@ -0,0 +1,51 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "Board.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+struct TimeControl {
+    int baseMs;             // 0 = no clock
+    int incrementMs;
+    int movesPerPeriod;     // 0 = sudden death, otherwise base is added every N moves
+
+    TimeControl() : baseMs(0), incrementMs(0), movesPerPeriod(0) {}
+
+    bool enabled() const { return baseMs > 0; }
+
+    // Parses "[moves/]base[+increment]" in seconds, e.g. "1+0.01" or "40/60"
+    static bool parse(const std::string& text, TimeControl& control);
+};
+
+// Chess clock for both players. The clock of the side to move runs from
+// start() or the previous punch() until the next punch().
+class GameClock {
+private:
+    TimeControl control;
+    int64_t remainingMs[2];
+    int movesMade[2];
+    Color running;
+    bool isRunning;
+    std::chrono::steady_clock::time_point turnStart;
+
+    int64_t elapsedMs() const;
+
+public:
+    GameClock();
+
+    void reset(const TimeControl& timeControl);
+    void start(Color side);
+    void stop();
+    // Ends the running side's turn and starts the opponent's clock.
+    // Returns false if the running side ran out of time.
+    bool punch();
+
+    bool enabled() const { return control.enabled(); }
+    const TimeControl& getControl() const { return control; }
+    int64_t remaining(Color side) const;    // Includes the running turn
+    int movesToGo(Color side) const;        // 0 for sudden death
+};
+
+#endif // CLOCK_H
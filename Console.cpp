@@ -1,12 +1,21 @@
 #include "../include/Game.h"
+#include "../include/MateSolver.h"
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
 
 class ConsoleUI {
 private:
+    // Declared before game, which may still be pondering with engine and
+    // reading book when it is destroyed
+    OpeningBook book;
+    Search engine;
     Game game;
+    MateSolver mateSolver;
 
     void printWelcome() {
         std::cout << "======================================\n";
@@ -19,10 +28,18 @@ private:
         std::cout << "  - 'help' - Show this help\n";
         std::cout << "  - 'moves' - Show legal moves\n";
         std::cout << "  - 'history' - Show move history\n";
+        std::cout << "  - 'board' - Show the board\n";
         std::cout << "  - 'undo' - Undo last move\n";
         std::cout << "  - 'new' - Start new game\n";
         std::cout << "  - 'save <filename>' - Save game\n";
         std::cout << "  - 'load <filename>' - Load game\n";
+        std::cout << "  - 'book <filename>' - Open an opening book built by chess_book\n";
+        std::cout << "  - 'bookmove' - Play a move from the opening book\n";
+        std::cout << "  - 'go [depth]' - Let the computer move\n";
+        std::cout << "  - 'analyze [depth] [lines]' - Show the best lines\n";
+        std::cout << "  - 'mate [moves] [nodes]' - Prove a forced mate for the side to move\n";
+        std::cout << "    (checking moves only, so mates that need a quiet move are not found)\n";
+        std::cout << "  - 'ponder on|off' - Think on the opponent's time\n";
         std::cout << "  - 'quit' - Exit game\n";
         std::cout << "\n";
     }
@@ -58,13 +75,77 @@ private:
         std::cout << "\n";
     }
 
+    void printPosition() {
+        game.printBoard();
+        game.printGameStatus();
+    }
+
+    static std::string trim(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) return "";
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    }
+
     std::string toLowerCase(const std::string& str) {
         std::string result = str;
         std::transform(result.begin(), result.end(), result.begin(), ::tolower);
         return result;
     }
 
-    void handleCommand(const std::string& input) {
+    bool analyze(const std::string& arguments) {
+        std::istringstream stream(arguments);
+        SearchLimits limits;
+        game.stopPondering();
+        if (!(stream >> limits.depth) || limits.depth <= 0) limits.depth = 4;
+        if (!(stream >> limits.multiPv) || limits.multiPv <= 0) limits.multiPv = 3;
+
+        SearchResult result = engine.think(game.getBoard(), limits);
+        if (result.bestMove.from == -1) {
+            std::cout << "\nNo legal moves.\n";
+            return false;
+        }
+
+        std::cout << "\nDepth " << result.depth << ", " << result.nodes << " nodes\n";
+        for (size_t i = 0; i < result.lines.size(); i++) {
+            const PvLine& line = result.lines[i];
+            std::cout << "  " << i + 1 << ". ";
+            if (Search::isMateScore(line.score)) {
+                int plies = Search::MATE_SCORE - std::abs(line.score);
+                std::cout << (line.score > 0 ? "mate " : "mated ") << (plies + 1) / 2;
+            } else {
+                std::cout << (line.score >= 0 ? "+" : "-") << std::abs(line.score) / 100 << "."
+                          << (std::abs(line.score) % 100 < 10 ? "0" : "") << std::abs(line.score) % 100;
+            }
+            std::cout << " ";
+            for (const Move& move : line.moves) {
+                std::cout << " " << game.formatMove(move);
+            }
+            std::cout << "\n";
+        }
+        return true;
+    }
+
+    bool findMate(const std::string& arguments) {
+        std::istringstream stream(arguments);
+        MateLimits limits;
+        if (!(stream >> limits.maxMoves) || limits.maxMoves <= 0) limits.maxMoves = 5;
+        if (!(stream >> limits.nodes)) limits.nodes = 10000000;
+
+        MateResult result = mateSolver.solve(game.getBoard(), limits);
+        if (result.status == MATE_PROVEN) {
+            std::cout << "\nMate in " << result.mateIn << ": " << result.notation;
+        } else if (result.status == MATE_DISPROVEN) {
+            // Only checking moves are tried, so a quiet mate may still exist
+            std::cout << "\nNo mate by checks in " << limits.maxMoves;
+        } else {
+            std::cout << "\nUnknown after " << limits.nodes << " nodes";
+        }
+        std::cout << " (" << result.nodes << " nodes)\n";
+        return result.status == MATE_PROVEN;
+    }
+
+    // Returns false when the command failed, for the batch exit status
+    bool handleCommand(const std::string& input) {
         std::string command = toLowerCase(input);
 
         if (command == "help") {
@@ -73,15 +154,60 @@ private:
             printLegalMoves();
         } else if (command == "history") {
             game.printMoveHistory();
+        } else if (command == "board") {
+            printPosition();
         } else if (command == "undo") {
             if (game.undoLastMove()) {
                 std::cout << "\nMove undone.\n";
             } else {
                 std::cout << "\nNo moves to undo.\n";
+                return false;
             }
         } else if (command == "new") {
             game.newGame();
             std::cout << "\nNew game started.\n";
+        } else if (command == "go" || command.substr(0, 3) == "go ") {
+            SearchLimits limits;
+            limits.depth = command.length() > 3 ? std::atoi(command.substr(3).c_str()) : 4;
+            if (limits.depth <= 0) limits.depth = 4;
+            if (game.makeComputerMove(engine, limits)) {
+                const Move& move = game.getMoveHistory().back();
+                std::cout << "\nComputer played: " << game.getBoard().squareToAlgebraic(move.from)
+                          << game.getBoard().squareToAlgebraic(move.to) << "\n";
+            } else {
+                std::cout << "\nNo move available.\n";
+                return false;
+            }
+        } else if (command == "analyze" || command.substr(0, 8) == "analyze ") {
+            return analyze(command.length() > 8 ? command.substr(8) : "");
+        } else if (command == "mate" || command.substr(0, 5) == "mate ") {
+            return findMate(command.length() > 5 ? command.substr(5) : "");
+        } else if (command == "ponder on" || command == "ponder off") {
+            game.setPondering(command == "ponder on");
+            std::cout << "\nPondering " << (command == "ponder on" ? "enabled" : "disabled") << ".\n";
+        } else if (command == "bookmove") {
+            if (game.playBookMove()) {
+                const Move& move = game.getMoveHistory().back();
+                std::cout << "\nBook move played: " << game.getBoard().squareToAlgebraic(move.from)
+                          << game.getBoard().squareToAlgebraic(move.to) << "\n";
+            } else {
+                std::cout << "\nNo book move for this position.\n";
+                return false;
+            }
+        } else if (command.substr(0, 4) == "book") {
+            if (command.length() > 5) {
+                std::string filename = input.substr(5);
+                if (book.open(filename)) {
+                    game.setOpeningBook(&book);
+                    std::cout << "\nOpened book " << filename << " (" << book.size() << " entries)\n";
+                } else {
+                    std::cout << "\nFailed to open book.\n";
+                    return false;
+                }
+            } else {
+                std::cout << "\nUsage: book <filename>\n";
+                return false;
+            }
         } else if (command.substr(0, 4) == "save") {
             if (command.length() > 5) {
                 std::string filename = input.substr(5);
@@ -89,9 +215,11 @@ private:
                     std::cout << "\nGame saved to " << filename << "\n";
                 } else {
                     std::cout << "\nFailed to save game.\n";
+                    return false;
                 }
             } else {
                 std::cout << "\nUsage: save <filename>\n";
+                return false;
             }
         } else if (command.substr(0, 4) == "load") {
             if (command.length() > 5) {
@@ -100,9 +228,11 @@ private:
                     std::cout << "\nGame loaded from " << filename << "\n";
                 } else {
                     std::cout << "\nFailed to load game.\n";
+                    return false;
                 }
             } else {
                 std::cout << "\nUsage: load <filename>\n";
+                return false;
             }
         } else {
             // Try to parse as a move
@@ -111,8 +241,10 @@ private:
             } else {
                 std::cout << "\nInvalid move: " << input << "\n";
                 std::cout << "Type 'help' for command list or 'moves' for legal moves.\n";
+                return false;
             }
         }
+        return true;
     }
 
 public:
@@ -121,8 +253,7 @@ public:
 
         while (true) {
             // Display current game state
-            game.printBoard();
-            game.printGameStatus();
+            printPosition();
 
             // Check if game is over
             if (game.getResult() != GAME_ONGOING) {
@@ -132,11 +263,10 @@ public:
             // Get user input
             std::cout << "\nEnter move or command: ";
             std::string input;
-            std::getline(std::cin, input);
-
-            // Remove leading/trailing whitespace
-            input.erase(0, input.find_first_not_of(" \t"));
-            input.erase(input.find_last_not_of(" \t") + 1);
+            if (!std::getline(std::cin, input)) {
+                break;
+            }
+            input = trim(input);
 
             if (input.empty()) {
                 continue;
@@ -150,11 +280,65 @@ public:
             handleCommand(input);
         }
     }
+
+    // Runs commands without prompts or the welcome text. The board is only
+    // drawn by the 'board' command, or after every move with showBoards.
+    // Blank lines and lines starting with '#' are skipped. Returns the
+    // process exit status: 0 if every command succeeded, 1 otherwise.
+    int runBatch(std::istream& in, bool showBoards) {
+        int failures = 0;
+        std::string input;
+        while (std::getline(in, input)) {
+            input = trim(input);
+            if (input.empty() || input[0] == '#') continue;
+            std::string command = toLowerCase(input);
+            if (command == "quit" || command == "exit") break;
+
+            size_t moves = game.getMoveHistory().size();
+            if (!handleCommand(input)) failures++;
+            if (showBoards && game.getMoveHistory().size() != moves) printPosition();
+        }
+        std::cout.flush();
+        return failures == 0 ? 0 : 1;
+    }
 };
 
 // Main function for console version
-int main() {
+//   chess_console                          Interactive game
+//   chess_console --batch [file] [--board] Run commands from file or stdin;
+//                                          exits 2 on bad arguments or an unreadable file
+int main(int argc, char* argv[]) {
+    bool batch = false;
+    bool showBoards = false;
+    std::string filename;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--batch") batch = true;
+        else if (arg == "--board") showBoards = true;
+        else if (batch && filename.empty() && arg[0] != '-') filename = arg;
+        else {
+            std::cerr << "Usage: chess_console [--batch [file] [--board]]\n";
+            return 2;
+        }
+    }
+
+    if (!batch) {
+        ConsoleUI ui;
+        ui.run();
+        return 0;
+    }
+
+    // Scripts read the output in bulk, so let the stream buffer it
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    std::ifstream file;
+    if (!filename.empty()) {
+        file.open(filename);
+        if (!file.is_open()) {
+            std::cerr << "Cannot open " << filename << "\n";
+            return 2;
+        }
+    }
     ConsoleUI ui;
-    ui.run();
-    return 0;
+    return ui.runBatch(filename.empty() ? std::cin : file, showBoards);
 }
@@ -0,0 +1,110 @@
+#include "../include/Evaluation.h"
+
+namespace {
+
+// Tables are written rank 8 first so they read like a board diagram
+const int PAWN_TABLE[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+const int KNIGHT_TABLE[64] = {
+    -50,-40,-30,-30,-30,-30,-40,-50,
+    -40,-20,  0,  0,  0,  0,-20,-40,
+    -30,  0, 10, 15, 15, 10,  0,-30,
+    -30,  5, 15, 20, 20, 15,  5,-30,
+    -30,  0, 15, 20, 20, 15,  0,-30,
+    -30,  5, 10, 15, 15, 10,  5,-30,
+    -40,-20,  0,  5,  5,  0,-20,-40,
+    -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+const int BISHOP_TABLE[64] = {
+    -20,-10,-10,-10,-10,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5, 10, 10,  5,  0,-10,
+    -10,  5,  5, 10, 10,  5,  5,-10,
+    -10,  0, 10, 10, 10, 10,  0,-10,
+    -10, 10, 10, 10, 10, 10, 10,-10,
+    -10,  5,  0,  0,  0,  0,  5,-10,
+    -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+const int ROOK_TABLE[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0
+};
+
+const int QUEEN_TABLE[64] = {
+    -20,-10,-10, -5, -5,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5,  5,  5,  5,  0,-10,
+     -5,  0,  5,  5,  5,  5,  0, -5,
+      0,  0,  5,  5,  5,  5,  0, -5,
+    -10,  5,  5,  5,  5,  5,  0,-10,
+    -10,  0,  5,  0,  0,  0,  0,-10,
+    -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+const int KING_TABLE[64] = {
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+     20, 20,  0,  0,  0,  0, 20, 20,
+     20, 30, 10,  0,  0, 10, 30, 20
+};
+
+EvalWeights buildDefaults() {
+    static const int* const tables[7] = {
+        nullptr, PAWN_TABLE, KNIGHT_TABLE, BISHOP_TABLE, ROOK_TABLE, QUEEN_TABLE, KING_TABLE
+    };
+    static const int values[7] = {0, 100, 320, 330, 500, 900, 0};
+
+    EvalWeights weights;
+    for (int type = 0; type < 7; type++) {
+        weights.pieceValue[type] = values[type];
+        for (int sq = 0; sq < 64; sq++) {
+            // Flip rank-8-first tables into a1 = 0 order
+            weights.pieceSquare[type][sq] = tables[type] ? tables[type][sq ^ 56] : 0;
+        }
+    }
+    return weights;
+}
+
+} // namespace
+
+const EvalWeights& EvalWeights::defaults() {
+    static const EvalWeights weights = buildDefaults();
+    return weights;
+}
+
+int Evaluator::evaluate(const Board& board, const EvalWeights& weights) {
+    int score = 0;
+    for (int sq = 0; sq < 64; sq++) {
+        Piece piece = board.getPiece(sq);
+        if (piece == EMPTY) continue;
+
+        PieceType type = pieceType(piece);
+        if (piece <= W_KING) {
+            score += weights.pieceValue[type] + weights.pieceSquare[type][sq];
+        } else {
+            score -= weights.pieceValue[type] + weights.pieceSquare[type][sq ^ 56];
+        }
+    }
+    return board.getCurrentPlayer() == WHITE ? score : -score;
+}
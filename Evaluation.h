@@ -0,0 +1,28 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "Board.h"
+
+// Piece types shared by the evaluation tables, independent of color
+enum PieceType { NO_TYPE = 0, PAWN = 1, KNIGHT = 2, BISHOP = 3, ROOK = 4, QUEEN = 5, KING = 6 };
+
+inline PieceType pieceType(Piece piece) {
+    return piece == EMPTY ? NO_TYPE : (PieceType)((piece - 1) % 6 + 1);
+}
+
+// Tunable evaluation weights in centipawns. Piece-square tables are from
+// white's point of view with a1 = 0; black pieces use the mirrored square.
+struct EvalWeights {
+    int pieceValue[7];
+    int pieceSquare[7][64];
+
+    static const EvalWeights& defaults();
+};
+
+// Static evaluation from the side to move's point of view
+class Evaluator {
+public:
+    static int evaluate(const Board& board, const EvalWeights& weights = EvalWeights::defaults());
+};
+
+#endif // EVALUATION_H
@@ -1,20 +1,71 @@
 #include "../include/Game.h"
+#include "../include/Pgn.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 
-Game::Game() : result(GAME_ONGOING) {
+Game::Game() : result(GAME_ONGOING), timeForfeit(false), tablebaseResult(false), openingBook(nullptr), tablebase(nullptr),
+               tablebaseAdjudication(false), ponderEnabled(false), ponderSearch(nullptr),
+               ponderHit(false) {
     board.initializeStartingPosition();
 }
 
+Game::~Game() {
+    stopPondering();
+}
+
 void Game::newGame() {
+    stopPondering();
     board.initializeStartingPosition();
+    startPosition.clear();
     moveHistory.clear();
     result = GAME_ONGOING;
+    timeForfeit = false;
+    tablebaseResult = false;
+    startClock();
+}
+
+bool Game::newGame(const std::string& fen) {
+    stopPondering();
+    if (!board.loadFromFEN(fen)) {
+        newGame();
+        return false;
+    }
+    startPosition = fen;
+    moveHistory.clear();
+    timeForfeit = false;
+    checkGameEnd();
+    startClock();
+    return true;
+}
+
+void Game::startClock() {
+    clock.reset(clock.getControl());
+    clock.start(board.getCurrentPlayer());
 }
 
-Move Game::parseMove(const std::string& moveStr) {
+void Game::setTimeControl(const TimeControl& control) {
+    clock.reset(control);
+    clock.start(board.getCurrentPlayer());
+}
+
+void Game::applyClock(SearchLimits& limits) const {
+    applyClockFor(limits, board.getCurrentPlayer());
+}
+
+void Game::applyClockFor(SearchLimits& limits, Color side) const {
+    if (!clock.enabled()) return;
+    for (int color = WHITE; color <= BLACK; color++) {
+        // Never hand the search a non-positive time, which means "no clock"
+        int64_t remaining = clock.remaining(static_cast<Color>(color));
+        limits.timeMs[color] = static_cast<int>(std::max<int64_t>(1, remaining));
+        limits.incrementMs[color] = clock.getControl().incrementMs;
+    }
+    limits.movesToGo = clock.movesToGo(side);
+}
+
+Move Game::parseMove(const std::string& moveStr) const {
     Move move;
 
     // Handle standard algebraic notation like "e2e4" or "e2-e4"
@@ -113,13 +164,28 @@ std::string Game::formatMove(const Move& move) const {
 }
 
 void Game::checkGameEnd() {
-    if (board.isCheckmate()) {
+    TerminalReason terminal = board.getStatus().terminal;
+    if (terminal == TERMINAL_CHECKMATE) {
         result = (board.getCurrentPlayer() == WHITE) ? BLACK_WINS : WHITE_WINS;
-    } else if (board.isStalemate() || board.isDraw()) {
+    } else if (terminal != NOT_TERMINAL) {
         result = DRAW;
     } else {
         result = GAME_ONGOING;
     }
+
+    int wdl;
+    tablebaseResult = false;
+    if (result == GAME_ONGOING && tablebaseAdjudication && tablebase != nullptr &&
+        tablebase->probeWdl(board, wdl)) {
+        tablebaseResult = true;
+        if (wdl == 0) {
+            result = DRAW;
+        } else {
+            bool sideToMoveWins = wdl > 0;
+            bool whiteToMove = board.getCurrentPlayer() == WHITE;
+            result = (sideToMoveWins == whiteToMove) ? WHITE_WINS : BLACK_WINS;
+        }
+    }
 }
 
 bool Game::makeMove(const std::string& moveStr) {
@@ -127,13 +193,49 @@ bool Game::makeMove(const std::string& moveStr) {
     return makeMove(move);
 }
 
+size_t Game::replayMoves(const std::vector<std::string>& moves, MoveFormat format) {
+    size_t applied = 0;
+    for (const std::string& text : moves) {
+        if (format == MOVES_SAN) {
+            // fromSan only returns generated moves, so no second check is needed
+            Move move = Notation::fromSan(board, text);
+            if (move.from == -1) break;
+            board.applyMove(move);
+            moveHistory.push_back(move);
+        } else {
+            Move move = parseMove(text);
+            if (!board.makeMove(move)) break;
+            moveHistory.push_back(move);
+        }
+        applied++;
+    }
+    checkGameEnd();
+    return applied;
+}
+
 bool Game::makeMove(const Move& move) {
     if (result != GAME_ONGOING) {
         return false; // Game is over
     }
 
+    // A pondering engine either got the reply it expected or has to start over
+    if (ponderSearch != nullptr && !ponderHit) {
+        if (move.matches(ponderMove) && board.isValidMove(move)) {
+            ponderHit = true;
+            ponderSearch->ponderhit();
+        } else {
+            stopPondering();
+        }
+    }
+
     if (board.makeMove(move)) {
         moveHistory.push_back(move);
+        if (!clock.punch()) {
+            // The flag fell before the move was completed
+            timeForfeit = true;
+            result = (board.getCurrentPlayer() == WHITE) ? WHITE_WINS : BLACK_WINS;
+            return true;
+        }
         checkGameEnd();
         return true;
     }
@@ -145,16 +247,105 @@ bool Game::undoLastMove() {
     if (moveHistory.empty()) {
         return false;
     }
+    stopPondering();
 
     if (board.undoMove()) {
         moveHistory.pop_back();
         result = GAME_ONGOING; // Reset game result
+        timeForfeit = false;
+        tablebaseResult = false;
         return true;
     }
 
     return false;
 }
 
+bool Game::playBookMove() {
+    if (openingBook == nullptr || result != GAME_ONGOING) {
+        return false;
+    }
+
+    Move move;
+    if (!openingBook->pickMove(board, move)) {
+        return false; // Out of book
+    }
+    return makeMove(move);
+}
+
+bool Game::makeComputerMove(Search& search, const SearchLimits& limits) {
+    if (result != GAME_ONGOING) {
+        return false;
+    }
+
+    SearchResult searchResult;
+    bool searched = false;
+    if (ponderSearch == &search && ponderHit) {
+        // The ponder search became this move's search at the ponderhit. It
+        // ran to the limits of the previous move, so it only stands if
+        // those asked for no less than these.
+        ponderThread.join();
+        ponderSearch = nullptr;
+        if (ponderLimits.depth >= limits.depth && ponderLimits.nodes == limits.nodes &&
+            ponderLimits.moveTimeMs == limits.moveTimeMs && ponderLimits.multiPv == limits.multiPv) {
+            searchResult = ponderResult;
+            searched = true;
+        }
+    } else {
+        stopPondering();
+        if (playBookMove()) {
+            return true;
+        }
+    }
+    if (!searched) {
+        // After a ponderhit the table is warm, so this mostly costs the
+        // iterations the ponder search did not reach
+        SearchLimits budgeted = limits;
+        applyClock(budgeted);
+        searchResult = search.think(board, budgeted);
+    }
+
+    if (searchResult.bestMove.from == -1 || !makeMove(searchResult.bestMove)) {
+        return false;
+    }
+    if (ponderEnabled && result == GAME_ONGOING) {
+        startPondering(search, searchResult, limits);
+    }
+    return true;
+}
+
+void Game::setPondering(bool enabled) {
+    ponderEnabled = enabled;
+    if (!enabled) stopPondering();
+}
+
+void Game::startPondering(Search& search, const SearchResult& last, const SearchLimits& limits) {
+    if (last.pv.size() < 2) return;
+
+    Board ponderBoard = board;
+    if (!ponderBoard.makeMove(last.pv[1])) return;
+
+    // Budgeted from our clock, which stands still until the ponderhit;
+    // the opponent is on move on the game board
+    ponderMove = last.pv[1];
+    ponderHit = false;
+    ponderLimits = limits;
+    applyClockFor(ponderLimits, ponderBoard.getCurrentPlayer());
+    ponderLimits.ponder = true;
+    ponderSearch = &search;
+    search.clearSignals();
+    ponderThread = std::thread([this, ponderBoard] {
+        ponderResult = ponderSearch->think(ponderBoard, ponderLimits);
+    });
+}
+
+void Game::stopPondering() {
+    if (ponderSearch == nullptr) return;
+    ponderSearch->stop();
+    ponderThread.join();
+    ponderSearch = nullptr;
+    ponderHit = false;
+}
+
 void Game::printBoard() const {
     board.print();
 }
@@ -177,22 +368,47 @@ void Game::printMoveHistory() const {
     }
 }
 
+std::string Game::formatMoveHistory(MoveFormat format) const {
+    Board replay;
+    if (!startPosition.empty()) replay.loadFromFEN(startPosition);
+    int moveNumber = replay.getState().fullMoveNumber;
+
+    std::string text;
+    for (size_t i = 0; i < moveHistory.size(); i++) {
+        bool whiteMoves = replay.getCurrentPlayer() == WHITE;
+        if (i > 0) text += " ";
+        if (whiteMoves) text += std::to_string(moveNumber) + ". ";
+        else if (i == 0) text += std::to_string(moveNumber) + "... ";
+        text += format == MOVES_SAN ? Notation::toSan(replay, moveHistory[i]) : formatMove(moveHistory[i]);
+        replay.applyMove(moveHistory[i]);
+        if (!whiteMoves) moveNumber++;
+    }
+    return text;
+}
+
 void Game::printGameStatus() const {
+    const PositionStatus& status = board.getStatus();
     switch (result) {
         case GAME_ONGOING:
-            if (board.isInCheck(board.getCurrentPlayer())) {
+            if (status.inCheck) {
                 std::cout << "\n" << (board.getCurrentPlayer() == WHITE ? "White" : "Black") 
                          << " is in check!\n";
             }
             break;
         case WHITE_WINS:
-            std::cout << "\nCheckmate! White wins!\n";
+            if (timeForfeit) std::cout << "\nBlack lost on time! White wins!\n";
+            else if (tablebaseResult) std::cout << "\nTablebase win! White wins!\n";
+            else std::cout << "\nCheckmate! White wins!\n";
             break;
         case BLACK_WINS:
-            std::cout << "\nCheckmate! Black wins!\n";
+            if (timeForfeit) std::cout << "\nWhite lost on time! Black wins!\n";
+            else if (tablebaseResult) std::cout << "\nTablebase win! Black wins!\n";
+            else std::cout << "\nCheckmate! Black wins!\n";
             break;
         case DRAW:
-            if (board.isStalemate()) {
+            if (tablebaseResult) {
+                std::cout << "\nTablebase draw! The game is a draw.\n";
+            } else if (status.terminal == TERMINAL_STALEMATE) {
                 std::cout << "\nStalemate! The game is a draw.\n";
             } else {
                 std::cout << "\nDraw!\n";
@@ -213,7 +429,7 @@ std::vector<std::string> Game::getLegalMovesAsStrings() const {
 }
 
 bool Game::isValidMoveString(const std::string& moveStr) const {
-    Move move = const_cast<Game*>(this)->parseMove(moveStr);
+    Move move = parseMove(moveStr);
     return board.isValidMove(move);
 }
 
@@ -238,21 +454,21 @@ bool Game::loadGame(const std::string& filename) {
         return false;
     }
 
-    // Start new game
-    newGame();
-
+    std::vector<std::string> moves;
     std::string line;
     while (std::getline(file, line)) {
         if (!line.empty()) {
-            if (!makeMove(line)) {
-                // Invalid move found, restore to initial state
-                newGame();
-                file.close();
-                return false;
-            }
+            moves.push_back(line);
         }
     }
-
     file.close();
+
+    // Start new game
+    newGame();
+    if (replayMoves(moves) != moves.size()) {
+        // Invalid move found, restore to initial state
+        newGame();
+        return false;
+    }
     return true;
 }
@@ -2,7 +2,12 @@
 #define GAME_H
 
 #include "Board.h"
+#include "Clock.h"
+#include "OpeningBook.h"
+#include "Search.h"
+#include "Tablebase.h"
 #include <string>
+#include <thread>
 #include <vector>
 
 enum GameResult {
@@ -12,34 +17,102 @@ enum GameResult {
     DRAW
 };
 
+enum MoveFormat {
+    MOVES_COORDINATE,   // "e2e4", "e7e8q"
+    MOVES_SAN           // "e4", "Nf3", "O-O"
+};
+
 class Game {
 private:
     Board board;
+    std::string startPosition;  // FEN, empty for the standard start
     std::vector<Move> moveHistory;
     GameResult result;
+    bool timeForfeit;           // result was decided by a flag fall
+    bool tablebaseResult;       // result was adjudicated from a tablebase
+    GameClock clock;
+    OpeningBook* openingBook;   // Not owned, may be null
+    const Tablebase* tablebase; // Not owned, may be null
+    bool tablebaseAdjudication;
+
+    // Pondering: after a computer move, the engine keeps searching the
+    // position after the reply it expects
+    bool ponderEnabled;
+    Search* ponderSearch;       // Engine pondering in the background, null if none; not owned
+    Move ponderMove;
+    bool ponderHit;
+    SearchLimits ponderLimits;
+    SearchResult ponderResult;
+    std::thread ponderThread;
 
     // Helper methods
-    Move parseMove(const std::string& moveStr);
-    std::string formatMove(const Move& move) const;
     void checkGameEnd();
+    void startClock();
+    void applyClockFor(SearchLimits& limits, Color side) const;
+    void startPondering(Search& search, const SearchResult& last, const SearchLimits& limits);
 
 public:
     Game();
+    ~Game();
+
+    Game(const Game&) = delete;
+    Game& operator=(const Game&) = delete;
 
     // Game control
     void newGame();
+    bool newGame(const std::string& fen);
     bool makeMove(const std::string& moveStr);
     bool makeMove(const Move& move);
     bool undoLastMove();
 
+    // Bulk replay: one legality check per move and no game-end checks until
+    // the last move. Stops at the first illegal move; returns how many moves
+    // were applied.
+    size_t replayMoves(const std::vector<std::string>& moves, MoveFormat format = MOVES_COORDINATE);
+
+    // Clock; a disabled time control (the default) removes it. Both
+    // newGame overloads restart it with the same time control.
+    void setTimeControl(const TimeControl& control);
+    const GameClock& getClock() const { return clock; }
+    bool isTimeForfeit() const { return timeForfeit; }
+    // Copies the clock state into search limits
+    void applyClock(SearchLimits& limits) const;
+
+    // Computer play
+    void setOpeningBook(OpeningBook* book) { openingBook = book; }
+    bool playBookMove();
+    // Book move if there is one, otherwise searches with the given engine.
+    // With a clock running, the search is budgeted from it. With pondering
+    // on, the engine keeps searching in the background after the move, so
+    // it must outlive the game or be released with stopPondering() first.
+    bool makeComputerMove(Search& search, const SearchLimits& limits);
+    // Ponder on the opponent's time after each computer move
+    void setPondering(bool enabled);
+    bool isPondering() const { return ponderSearch != nullptr; }
+    // Cancels the background search, e.g. before using its engine elsewhere
+    void stopPondering();
+
+    // Endgame tablebases. With adjudication on, a tablebase hit ends the
+    // game with its theoretical result.
+    void setTablebase(const Tablebase* tb, bool adjudicate) {
+        tablebase = tb;
+        tablebaseAdjudication = adjudicate;
+    }
+    // The result comes from a tablebase probe rather than the board
+    bool isTablebaseResult() const { return tablebaseResult; }
+
     // Game state access
     const Board& getBoard() const { return board; }
     GameResult getResult() const { return result; }
     const std::vector<Move>& getMoveHistory() const { return moveHistory; }
+    const std::string& getStartPosition() const { return startPosition; }
 
     // Display
     void printBoard() const;
     void printMoveHistory() const;
+    // Numbered move text from the start position, e.g. "1. e4 e5 2. Nf3" or
+    // "23... Kg8 24. Qh7#"
+    std::string formatMoveHistory(MoveFormat format = MOVES_SAN) const;
     void printGameStatus() const;
 
     // Save/Load
@@ -47,6 +120,8 @@ public:
     bool loadGame(const std::string& filename);
 
     // Utilities
+    Move parseMove(const std::string& moveStr) const;   // "e2e4", "e7e8q"; from == -1 if malformed
+    std::string formatMove(const Move& move) const;     // "e2e4", "e7e8Q"
     std::vector<std::string> getLegalMovesAsStrings() const;
     bool isValidMoveString(const std::string& moveStr) const;
 };
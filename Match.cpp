@@ -0,0 +1,254 @@
+#include "../include/Match.h"
+#include "../include/Game.h"
+#include "../include/Pgn.h"
+#include "../include/ThreadPool.h"
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <sstream>
+
+MatchSettings::MatchSettings()
+    : games(100), concurrency(1), maxPlies(400),
+      resignScore(1000), resignMoves(4), drawScore(10), drawMoves(10), drawStartPly(80),
+      tablebase(nullptr), sprt(false), elo0(0.0), elo1(5.0), alpha(0.05), beta(0.05) {
+    engines[0].name = "engineA";
+    engines[1].name = "engineB";
+}
+
+double MatchStats::score() const {
+    return games() == 0 ? 0.5 : (wins + 0.5 * draws) / games();
+}
+
+double MatchStats::elo() const {
+    return MatchRunner::eloFromScore(score());
+}
+
+double MatchStats::eloError() const {
+    int n = games();
+    if (n == 0) return 0.0;
+
+    double s = score();
+    double variance = (wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) +
+                       losses * s * s) / n;
+    double margin = 1.96 * std::sqrt(variance / n);
+    return (MatchRunner::eloFromScore(s + margin) - MatchRunner::eloFromScore(s - margin)) / 2.0;
+}
+
+double MatchStats::llr(double elo0, double elo1) const {
+    // Normal approximation to the trinomial log-likelihood ratio
+    int n = games();
+    if (n == 0 || wins + losses == 0) return 0.0;
+
+    double s = score();
+    double variance = (wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) +
+                       losses * s * s) / n;
+    if (variance <= 0.0) return 0.0;
+
+    double s0 = 1.0 / (1.0 + std::pow(10.0, -elo0 / 400.0));
+    double s1 = 1.0 / (1.0 + std::pow(10.0, -elo1 / 400.0));
+    return n * (s1 - s0) * (2.0 * s - s0 - s1) / (2.0 * variance);
+}
+
+MatchRunner::MatchRunner(const MatchSettings& settings) : settings(settings) {}
+
+double MatchRunner::eloFromScore(double score) {
+    const double clamp = 1e-6;
+    if (score < clamp) score = clamp;
+    if (score > 1.0 - clamp) score = 1.0 - clamp;
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+void MatchRunner::sprtBounds(double alpha, double beta, double& lower, double& upper) {
+    lower = std::log(beta / (1.0 - alpha));
+    upper = std::log((1.0 - beta) / alpha);
+}
+
+int MatchRunner::playGame(int index, Search* engines[2], SearchStats totals[2],
+                          std::string& pgn, bool& timeForfeit) const {
+    // Game pairs share an opening with colors reversed
+    int whiteEngine = index % 2;
+    std::string opening;
+    if (!settings.openings.empty()) {
+        opening = settings.openings[(index / 2) % settings.openings.size()];
+    }
+
+    Game game;
+    if (!opening.empty() && !game.newGame(opening)) {
+        opening.clear();
+    }
+    game.setTablebase(settings.tablebase, settings.tablebase != nullptr);
+    game.setTimeControl(settings.timeControl);
+    engines[0]->newGame();
+    engines[1]->newGame();
+
+    std::vector<std::string> sanMoves;
+    std::string termination;
+    GameResult result = game.getResult();
+    int resignCount = 0, drawCount = 0;
+    int resignSign = 0;         // Score sign being counted, +1 when white is winning
+    int ply = 0;
+
+    while (result == GAME_ONGOING) {
+        if (ply >= settings.maxPlies) {
+            result = DRAW;
+            termination = "max plies";
+            break;
+        }
+
+        const Board& board = game.getBoard();
+        bool whiteToMove = board.getCurrentPlayer() == WHITE;
+        int engineIndex = whiteToMove ? whiteEngine : 1 - whiteEngine;
+        SearchLimits limits = settings.limits;
+        game.applyClock(limits);
+        SearchResult searchResult = engines[engineIndex]->think(board, limits);
+        totals[engineIndex].merge(engines[engineIndex]->getStats());
+        if (searchResult.bestMove.from == -1) {
+            break;
+        }
+
+        sanMoves.push_back(Notation::toSan(board, searchResult.bestMove));
+        if (!game.makeMove(searchResult.bestMove)) {
+            termination = "illegal move";
+            result = whiteToMove ? BLACK_WINS : WHITE_WINS;
+            break;
+        }
+        ply++;
+
+        result = game.getResult();
+        if (game.isTimeForfeit()) {
+            termination = "time forfeit";
+            break;
+        }
+        if (result != GAME_ONGOING) {
+            switch (game.getBoard().getStatus().terminal) {
+                case TERMINAL_CHECKMATE: termination = "checkmate"; break;
+                case TERMINAL_STALEMATE: termination = "stalemate"; break;
+                case NOT_TERMINAL: termination = "tablebase"; break;
+                default: termination = "draw rule"; break;
+            }
+            break;
+        }
+
+        // Score adjudication, from white's point of view
+        int score = whiteToMove ? searchResult.score : -searchResult.score;
+        if (settings.resignMoves > 0 && std::abs(score) >= settings.resignScore) {
+            // Only plies that agree on the losing side count in a row
+            int sign = score > 0 ? 1 : -1;
+            if (sign != resignSign) resignCount = 0;
+            resignSign = sign;
+            if (++resignCount >= 2 * settings.resignMoves) {
+                result = score > 0 ? WHITE_WINS : BLACK_WINS;
+                termination = "resign";
+            }
+        } else {
+            resignCount = 0;
+        }
+        if (settings.drawMoves > 0 && ply >= settings.drawStartPly &&
+            std::abs(score) <= settings.drawScore) {
+            if (++drawCount >= 2 * settings.drawMoves && result == GAME_ONGOING) {
+                result = DRAW;
+                termination = "adjudicated draw";
+            }
+        } else {
+            drawCount = 0;
+        }
+    }
+
+    const char* resultText = result == WHITE_WINS ? "1-0" : result == BLACK_WINS ? "0-1"
+                           : result == DRAW ? "1/2-1/2" : "*";
+
+    std::ostringstream out;
+    out << "[Event \"Self-play\"]\n";
+    out << "[Round \"" << index + 1 << "\"]\n";
+    out << "[White \"" << settings.engines[whiteEngine].name << "\"]\n";
+    out << "[Black \"" << settings.engines[1 - whiteEngine].name << "\"]\n";
+    out << "[Result \"" << resultText << "\"]\n";
+    if (!opening.empty()) {
+        out << "[SetUp \"1\"]\n";
+        out << "[FEN \"" << opening << "\"]\n";
+    }
+    out << "[Termination \"" << termination << "\"]\n\n";
+
+    // Move numbers continue from the opening position
+    Board start;
+    if (!opening.empty()) start.loadFromFEN(opening);
+    int moveNumber = start.getState().fullMoveNumber;
+    bool whiteMoves = start.getCurrentPlayer() == WHITE;
+    size_t lineLength = 0;
+    for (size_t i = 0; i < sanMoves.size(); i++) {
+        std::string token;
+        if (whiteMoves) token = std::to_string(moveNumber) + ". ";
+        else if (i == 0) token = std::to_string(moveNumber) + "... ";
+        token += sanMoves[i];
+        if (lineLength + token.size() > 79) {
+            out << "\n";
+            lineLength = 0;
+        } else if (lineLength > 0) {
+            out << " ";
+            lineLength++;
+        }
+        out << token;
+        lineLength += token.size();
+        if (!whiteMoves) moveNumber++;
+        whiteMoves = !whiteMoves;
+    }
+    out << (lineLength > 0 ? " " : "") << resultText << "\n\n";
+    pgn = out.str();
+    timeForfeit = game.isTimeForfeit();
+
+    // Result for engine 0
+    if (result == DRAW || result == GAME_ONGOING) return 0;
+    bool whiteWon = result == WHITE_WINS;
+    return (whiteWon == (whiteEngine == 0)) ? 1 : -1;
+}
+
+MatchStats MatchRunner::run(std::ostream* pgn, const std::function<void(const MatchStats&)>& progress) {
+    MatchStats stats;
+    std::mutex statsMutex;
+    std::atomic<int> nextGame(0);
+    std::atomic<bool> finished(false);
+
+    double lower = 0.0, upper = 0.0;
+    sprtBounds(settings.alpha, settings.beta, lower, upper);
+
+    ThreadPool pool(settings.concurrency);
+    for (int worker = 0; worker < pool.size(); worker++) {
+        pool.submit([&] {
+            // Each worker keeps its own pair of engines for every game it plays
+            Search engineA(settings.engines[0]);
+            Search engineB(settings.engines[1]);
+            Search* engines[2] = {&engineA, &engineB};
+
+            while (!finished) {
+                int index = nextGame++;
+                if (index >= settings.games) break;
+
+                std::string gamePgn;
+                SearchStats gameStats[2];
+                bool timeForfeit = false;
+                int outcome = playGame(index, engines, gameStats, gamePgn, timeForfeit);
+
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.searchStats[0].merge(gameStats[0]);
+                stats.searchStats[1].merge(gameStats[1]);
+                if (timeForfeit) stats.timeForfeits++;
+                if (outcome > 0) stats.wins++;
+                else if (outcome < 0) stats.losses++;
+                else stats.draws++;
+
+                if (pgn != nullptr) {
+                    *pgn << gamePgn;
+                    pgn->flush();
+                }
+                if (progress) progress(stats);
+
+                if (settings.sprt) {
+                    double llr = stats.llr(settings.elo0, settings.elo1);
+                    if (llr <= lower || llr >= upper) finished = true;
+                }
+            }
+        });
+    }
+    pool.wait();
+    return stats;
+}
@@ -0,0 +1,75 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include "Clock.h"
+#include "Search.h"
+#include "SearchStats.h"
+#include "Tablebase.h"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct MatchSettings {
+    EngineConfig engines[2];
+    SearchLimits limits;            // Per move, for both engines
+    TimeControl timeControl;        // Game clock; limits still apply on top
+    int games;
+    int concurrency;                // Games played at once
+    std::vector<std::string> openings;  // FENs, each played with both colors
+    int maxPlies;
+
+    // Adjudication, scores in centipawns; a count of 0 disables the rule
+    int resignScore;
+    int resignMoves;                // Consecutive moves both engines agree
+    int drawScore;
+    int drawMoves;
+    int drawStartPly;
+    const Tablebase* tablebase;
+
+    // Sequential probability ratio test on engine 0 vs engine 1
+    bool sprt;
+    double elo0;
+    double elo1;
+    double alpha;
+    double beta;
+
+    MatchSettings();
+};
+
+// Results from engine 0's point of view
+struct MatchStats {
+    int wins;
+    int draws;
+    int losses;
+    int timeForfeits;              // Games lost on time by either engine
+    SearchStats searchStats[2];    // Per engine, summed over all searches
+
+    MatchStats() : wins(0), draws(0), losses(0), timeForfeits(0) {}
+
+    int games() const { return wins + draws + losses; }
+    double score() const;
+    double elo() const;
+    double eloError() const;       // 95% confidence half-width
+    double llr(double elo0, double elo1) const;
+};
+
+class MatchRunner {
+private:
+    MatchSettings settings;
+
+    int playGame(int index, Search* engines[2], SearchStats totals[2], std::string& pgn,
+                 bool& timeForfeit) const;
+
+public:
+    explicit MatchRunner(const MatchSettings& settings);
+
+    // Plays the match; games are appended to pgn as they finish and
+    // progress is called after every game. Stops early once SPRT decides.
+    MatchStats run(std::ostream* pgn, const std::function<void(const MatchStats&)>& progress);
+
+    static double eloFromScore(double score);
+    static void sprtBounds(double alpha, double beta, double& lower, double& upper);
+};
+
+#endif // MATCH_H
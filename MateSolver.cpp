@@ -0,0 +1,225 @@
+#include "../include/MateSolver.h"
+#include "../include/Game.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Proof and disproof numbers stop at infinity
+uint32_t saturate(uint64_t value) {
+    return value >= MateSolver::INFINITE_NUMBER ? MateSolver::INFINITE_NUMBER : static_cast<uint32_t>(value);
+}
+
+} // namespace
+
+MateSolver::MateSolver(size_t megabytes) : mask(0), nodes(0), nodeLimit(0), stack(2 * MAX_MOVES + 2) {
+    size_t count = 2;
+    size_t target = (megabytes == 0 ? 1 : megabytes) * 1024 * 1024 / sizeof(Entry);
+    while (count * 2 <= target) {
+        count *= 2;
+    }
+    table.assign(count, Entry());
+    mask = count - 1;
+}
+
+void MateSolver::clear() {
+    table.assign(table.size(), Entry());
+}
+
+uint64_t MateSolver::nodeKey(int remaining) const {
+    return board.getHash() ^ (static_cast<uint64_t>(remaining) * 0x9E3779B97F4A7C15ULL);
+}
+
+const MateSolver::Entry* MateSolver::probe(uint64_t key) const {
+    const Entry* bucket = &table[key & mask & ~static_cast<size_t>(1)];
+    if (bucket[0].key == key && bucket[0].work != 0) return &bucket[0];
+    if (bucket[1].key == key && bucket[1].work != 0) return &bucket[1];
+    return nullptr;
+}
+
+void MateSolver::store(uint64_t key, uint32_t proof, uint32_t disproof, uint16_t distance, uint64_t work) {
+    Entry* bucket = &table[key & mask & ~static_cast<size_t>(1)];
+    Entry* slot;
+    if (bucket[0].key == key) slot = &bucket[0];
+    else if (bucket[1].key == key) slot = &bucket[1];
+    else slot = bucket[0].work <= bucket[1].work ? &bucket[0] : &bucket[1];
+
+    slot->key = key;
+    slot->proof = proof;
+    slot->disproof = disproof;
+    slot->distance = distance;
+    slot->work = static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(work, 1), UINT32_MAX));
+}
+
+MateSolver::Entry MateSolver::lookup(int ply, int remaining) {
+    uint64_t key = nodeKey(remaining);
+    const Entry* found = probe(key);
+    if (found != nullptr) return *found;
+
+    Entry entry = {key, 1, 1, 1, 0};
+    nodes++;
+    if (ply % 2 == 1) {
+        // The defender is in check: no reply is mate, and fewer replies are
+        // likelier to be refuted. A reply must leave the attacker a move.
+        MoveList& replies = stack[ply];
+        board.generateLegalMoves(replies);
+        if (replies.empty()) {
+            entry.proof = 0;
+            entry.disproof = INFINITE_NUMBER;
+        } else if (remaining <= 1) {
+            entry.proof = INFINITE_NUMBER;
+            entry.disproof = 0;
+        } else {
+            entry.proof = static_cast<uint32_t>(replies.size());
+        }
+    }
+    store(key, entry.proof, entry.disproof, entry.distance, 1);
+    return entry;
+}
+
+// Multiple-iterative deepening on the current position: expands the most
+// proving child until the node's proof or disproof number reaches its limit
+void MateSolver::expand(int ply, int remaining, uint32_t proofLimit, uint32_t disproofLimit) {
+    bool attacker = ply % 2 == 0;
+    uint64_t key = nodeKey(remaining);
+    uint64_t startNodes = nodes;
+    nodes++;
+
+    MoveList& moves = stack[ply];
+    board.generateLegalMoves(moves, attacker ? GEN_CHECKS : GEN_ALL);
+    if (moves.empty()) {
+        // No check to give; a defender without a move is mated
+        bool mated = !attacker && board.isInCheck(board.getCurrentPlayer());
+        store(key, mated ? 0 : INFINITE_NUMBER, mated ? INFINITE_NUMBER : 0, 0, 1);
+        return;
+    }
+
+    while (true) {
+        // The attacker needs one proven child, the defender all of them.
+        // The child to expand has the smallest number on the side that
+        // decides the node; second is the runner-up.
+        uint64_t sum = 0;
+        uint32_t bestValue = INFINITE_NUMBER, second = INFINITE_NUMBER;
+        Entry bestChild = {};
+        int best = 0;
+        int distance = attacker ? INT32_MAX : 0;
+        for (int i = 0; i < moves.size(); i++) {
+            board.applyMove(moves[i]);
+            Entry child = lookup(ply + 1, remaining - 1);
+            board.undoMove();
+
+            uint32_t value = attacker ? child.proof : child.disproof;
+            if (value < bestValue || i == 0) {
+                second = bestValue;
+                bestValue = value;
+                bestChild = child;
+                best = i;
+            } else if (value < second) {
+                second = value;
+            }
+            sum += attacker ? child.disproof : child.proof;
+            if (attacker && child.proof == 0) distance = std::min(distance, child.distance + 1);
+            if (!attacker) distance = std::max(distance, child.distance + 1);
+        }
+
+        uint32_t proof = attacker ? bestValue : saturate(sum);
+        uint32_t disproof = attacker ? saturate(sum) : bestValue;
+        if (proof >= proofLimit || disproof >= disproofLimit || outOfNodes()) {
+            store(key, proof, disproof, static_cast<uint16_t>(proof == 0 ? distance : 0), nodes - startNodes);
+            return;
+        }
+
+        // The child may work until it stops being the best one, or until
+        // its share would push this node over its own limit
+        uint32_t childProof, childDisproof;
+        if (attacker) {
+            childProof = std::min(proofLimit, saturate(static_cast<uint64_t>(second) + 1));
+            childDisproof = saturate(static_cast<uint64_t>(disproofLimit) - disproof + bestChild.disproof);
+        } else {
+            childProof = saturate(static_cast<uint64_t>(proofLimit) - proof + bestChild.proof);
+            childDisproof = std::min(disproofLimit, saturate(static_cast<uint64_t>(second) + 1));
+        }
+        board.applyMove(moves[best]);
+        expand(ply + 1, remaining - 1, childProof, childDisproof);
+        board.undoMove();
+    }
+}
+
+// Follows proven children from the root: the attacker's quickest mate and
+// the defender's longest resistance. Children whose entries were replaced
+// are proven again.
+bool MateSolver::extractLine(int remaining, std::vector<Move>& line) {
+    for (int ply = 0;; ply++, remaining--) {
+        bool attacker = ply % 2 == 0;
+        MoveList& moves = stack[ply];
+        board.generateLegalMoves(moves, attacker ? GEN_CHECKS : GEN_ALL);
+        if (moves.empty()) return !attacker && board.isInCheck(board.getCurrentPlayer());
+
+        int best = -1;
+        int bestDistance = 0;
+        for (int i = 0; i < moves.size(); i++) {
+            board.applyMove(moves[i]);
+            Entry child = lookup(ply + 1, remaining - 1);
+            if (child.proof != 0 && !attacker) {
+                expand(ply + 1, remaining - 1, INFINITE_NUMBER, INFINITE_NUMBER);
+                child = lookup(ply + 1, remaining - 1);
+            }
+            board.undoMove();
+            if (child.proof != 0) {
+                if (!attacker) return false;
+                continue;
+            }
+            if (best == -1 || (attacker ? child.distance < bestDistance : child.distance > bestDistance)) {
+                best = i;
+                bestDistance = child.distance;
+            }
+        }
+        if (best == -1) {
+            // Every proven child was replaced; prove this node once more
+            expand(ply, remaining, INFINITE_NUMBER, INFINITE_NUMBER);
+            const Entry* entry = probe(nodeKey(remaining));
+            if (entry == nullptr || entry->proof != 0) return false;
+            ply--;
+            remaining++;
+            continue;
+        }
+        line.push_back(moves[best]);
+        board.applyMove(moves[best]);
+    }
+}
+
+MateResult MateSolver::solve(const Board& position, const MateLimits& limits) {
+    auto start = std::chrono::steady_clock::now();
+    MateResult result;
+    nodes = 0;
+    nodeLimit = limits.nodes;
+
+    int maxMoves = std::max(1, std::min(limits.maxMoves, static_cast<int>(MAX_MOVES)));
+    for (int moves = limits.shortest ? 1 : maxMoves; moves <= maxMoves; moves++) {
+        board = position;
+        int remaining = 2 * moves - 1;
+        expand(0, remaining, INFINITE_NUMBER, INFINITE_NUMBER);
+
+        const Entry* root = probe(nodeKey(remaining));
+        if (root != nullptr && root->proof == 0) {
+            result.status = MATE_PROVEN;
+            result.mateIn = (root->distance + 1) / 2;
+            // Finishing a proven line is not held to the budget
+            nodeLimit = 0;
+            if (!extractLine(remaining, result.line)) result.line.clear();
+            break;
+        }
+        if (outOfNodes() || root == nullptr) break;
+        if (moves == maxMoves) result.status = MATE_DISPROVEN;
+    }
+
+    if (!result.line.empty()) {
+        Game game;
+        game.newGame(position.toFEN());
+        for (const Move& move : result.line) game.makeMove(move);
+        result.notation = game.formatMoveHistory(MOVES_SAN);
+    }
+    result.nodes = nodes;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
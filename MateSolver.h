@@ -0,0 +1,84 @@
+#ifndef MATE_SOLVER_H
+#define MATE_SOLVER_H
+
+#include "Board.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct MateLimits {
+    int maxMoves;           // Longest mate looked for, in moves of the side to move
+    uint64_t nodes;         // 0 = unlimited
+    // Look for mate in 1, 2, ... maxMoves in turn, so the mate found is
+    // the shortest; otherwise any mate within maxMoves is accepted
+    bool shortest;
+
+    MateLimits() : maxMoves(8), nodes(0), shortest(true) {}
+};
+
+enum MateStatus {
+    MATE_PROVEN,
+    MATE_DISPROVEN,         // No mate within maxMoves by checks alone
+    MATE_UNKNOWN            // Node budget ran out first
+};
+
+struct MateResult {
+    MateStatus status;
+    int mateIn;             // Moves of the side to move, once proven
+    std::vector<Move> line; // Attacker and defender moves down to the mate
+    std::string notation;   // The line in numbered SAN, e.g. "1. Qh5+ g6 2. Qxg6#"
+    uint64_t nodes;
+    double seconds;
+
+    MateResult() : status(MATE_UNKNOWN), mateIn(0), nodes(0), seconds(0.0) {}
+};
+
+// Proves or disproves a forced mate by the side to move with depth-first
+// proof-number search (df-pn). The attacker only tries checking moves, the
+// defender every legal reply, so mates that need a quiet move are not
+// found. Proof and disproof numbers are kept in a fixed-size hash table;
+// the key includes the plies left, so results bounded by different depths
+// never mix.
+class MateSolver {
+public:
+    static const int MAX_MOVES = 31;
+    static const uint32_t INFINITE_NUMBER = 100000000;
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t proof;
+        uint32_t disproof;
+        uint32_t work;          // Nodes spent on it, the replacement priority
+        uint16_t distance;      // Plies to mate once proven
+    };
+
+    // Two-entry buckets; a new entry replaces the one with less work
+    std::vector<Entry> table;
+    size_t mask;
+
+    Board board;
+    uint64_t nodes;
+    uint64_t nodeLimit;         // 0 = unlimited
+    std::vector<MoveList> stack;
+
+    uint64_t nodeKey(int remaining) const;
+    const Entry* probe(uint64_t key) const;
+    void store(uint64_t key, uint32_t proof, uint32_t disproof, uint16_t distance, uint64_t work);
+    bool outOfNodes() const { return nodeLimit != 0 && nodes >= nodeLimit; }
+
+    // Numbers of the current position as a child; positions not yet in
+    // the table are scored and stored on first sight
+    Entry lookup(int ply, int remaining);
+    void expand(int ply, int remaining, uint32_t proofLimit, uint32_t disproofLimit);
+    bool extractLine(int remaining, std::vector<Move>& line);
+
+public:
+    explicit MateSolver(size_t megabytes = 16);
+
+    void clear();
+    MateResult solve(const Board& position, const MateLimits& limits);
+};
+
+#endif // MATE_SOLVER_H
@@ -0,0 +1,293 @@
+#include "../include/Nnue.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+// File layout, see Nnue.h. Every section starts at a multiple of 32
+// bytes, so the mapped weights can be read with aligned vector loads.
+const size_t HEADER_SIZE = 64;
+const size_t FEATURE_BIAS_OFFSET = HEADER_SIZE;
+const size_t FEATURE_WEIGHTS_OFFSET = FEATURE_BIAS_OFFSET + NNUE_HIDDEN * sizeof(int16_t);
+const size_t HIDDEN_WEIGHTS_OFFSET =
+    FEATURE_WEIGHTS_OFFSET + size_t(NnueNetwork::INPUTS) * NNUE_HIDDEN * sizeof(int16_t);
+const size_t HIDDEN_BIAS_OFFSET = HIDDEN_WEIGHTS_OFFSET + NnueNetwork::HIDDEN2 * 2 * NNUE_HIDDEN;
+const size_t OUTPUT_WEIGHTS_OFFSET = HIDDEN_BIAS_OFFSET + NnueNetwork::HIDDEN2 * sizeof(int32_t);
+const size_t OUTPUT_BIAS_OFFSET = OUTPUT_WEIGHTS_OFFSET + NnueNetwork::HIDDEN2;
+const size_t FILE_SIZE = OUTPUT_BIAS_OFFSET + sizeof(int32_t);
+const char MAGIC[4] = {'C', 'N', 'U', 'E'};
+
+// The layers after the accumulator
+struct Layers {
+    const int8_t* hiddenWeights;
+    const int32_t* hiddenBias;
+    const int8_t* outputWeights;
+    int32_t outputBias;
+};
+
+int32_t readInt32(const unsigned char* data) {
+    int32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint8_t clampActivation(int value) {
+    return static_cast<uint8_t>(std::min(std::max(value, 0), 127));
+}
+
+int32_t propagateScalar(const int16_t* us, const int16_t* them, const Layers& layers) {
+    uint8_t input[2 * NNUE_HIDDEN];
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        input[i] = clampActivation(us[i]);
+        input[NNUE_HIDDEN + i] = clampActivation(them[i]);
+    }
+
+    int32_t output = layers.outputBias;
+    for (int j = 0; j < NnueNetwork::HIDDEN2; j++) {
+        const int8_t* row = layers.hiddenWeights + j * 2 * NNUE_HIDDEN;
+        int32_t sum = layers.hiddenBias[j];
+        for (int i = 0; i < 2 * NNUE_HIDDEN; i++) {
+            sum += input[i] * row[i];
+        }
+        output += clampActivation(sum >> NnueNetwork::HIDDEN_SHIFT) * layers.outputWeights[j];
+    }
+    return output;
+}
+
+#ifdef CHESS_X86_64
+
+// maddubs multiplies unsigned activations (at most 127) by signed weights
+// and adds pairs into int16; 2 * 127 * 128 cannot saturate, so the vector
+// paths match the scalar one exactly
+
+TARGET_SSE41 int32_t horizontalSum(__m128i sum) {
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+TARGET_SSE41 int32_t propagateSse41(const int16_t* us, const int16_t* them, const Layers& layers) {
+    alignas(16) uint8_t input[2 * NNUE_HIDDEN];
+    const __m128i maximum = _mm_set1_epi16(127);
+    const __m128i ones = _mm_set1_epi16(1);
+    for (int half = 0; half < 2; half++) {
+        const int16_t* source = half == 0 ? us : them;
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m128i a = _mm_min_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(source + i)), maximum);
+            __m128i b = _mm_min_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(source + i + 8)), maximum);
+            _mm_store_si128(reinterpret_cast<__m128i*>(input + half * NNUE_HIDDEN + i), _mm_packus_epi16(a, b));
+        }
+    }
+
+    alignas(16) uint8_t hidden[NnueNetwork::HIDDEN2];
+    for (int j = 0; j < NnueNetwork::HIDDEN2; j++) {
+        const int8_t* row = layers.hiddenWeights + j * 2 * NNUE_HIDDEN;
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < 2 * NNUE_HIDDEN; i += 16) {
+            __m128i products = _mm_maddubs_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(input + i)),
+                                                 _mm_load_si128(reinterpret_cast<const __m128i*>(row + i)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+        }
+        hidden[j] = clampActivation((layers.hiddenBias[j] + horizontalSum(sum)) >> NnueNetwork::HIDDEN_SHIFT);
+    }
+
+    __m128i sum = _mm_setzero_si128();
+    for (int j = 0; j < NnueNetwork::HIDDEN2; j += 16) {
+        __m128i products = _mm_maddubs_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(hidden + j)),
+                                             _mm_load_si128(reinterpret_cast<const __m128i*>(layers.outputWeights + j)));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+    }
+    return layers.outputBias + horizontalSum(sum);
+}
+
+TARGET_AVX2 int32_t horizontalSum(__m256i sum) {
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+}
+
+TARGET_AVX2 int32_t propagateAvx2(const int16_t* us, const int16_t* them, const Layers& layers) {
+    alignas(32) uint8_t input[2 * NNUE_HIDDEN];
+    const __m256i maximum = _mm256_set1_epi16(127);
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int half = 0; half < 2; half++) {
+        const int16_t* source = half == 0 ? us : them;
+        for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+            __m256i a = _mm256_min_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(source + i)), maximum);
+            __m256i b = _mm256_min_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(source + i + 16)), maximum);
+            // packus interleaves the 128-bit halves of a and b; restore the order
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(input + half * NNUE_HIDDEN + i), packed);
+        }
+    }
+
+    // Four rows at a time, reduced together with hadd
+    alignas(32) uint8_t hidden[NnueNetwork::HIDDEN2];
+    for (int j = 0; j < NnueNetwork::HIDDEN2; j += 4) {
+        __m256i sums[4];
+        for (int k = 0; k < 4; k++) {
+            const int8_t* row = layers.hiddenWeights + (j + k) * 2 * NNUE_HIDDEN;
+            __m256i sum = _mm256_setzero_si256();
+            for (int i = 0; i < 2 * NNUE_HIDDEN; i += 32) {
+                __m256i products = _mm256_maddubs_epi16(
+                    _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i)),
+                    _mm256_load_si256(reinterpret_cast<const __m256i*>(row + i)));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+            }
+            sums[k] = sum;
+        }
+        __m256i pairs = _mm256_hadd_epi32(_mm256_hadd_epi32(sums[0], sums[1]), _mm256_hadd_epi32(sums[2], sums[3]));
+        __m128i totals = _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+        totals = _mm_add_epi32(totals, _mm_load_si128(reinterpret_cast<const __m128i*>(layers.hiddenBias + j)));
+        totals = _mm_srai_epi32(totals, NnueNetwork::HIDDEN_SHIFT);
+        alignas(16) int32_t values[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(values), totals);
+        for (int k = 0; k < 4; k++) hidden[j + k] = clampActivation(values[k]);
+    }
+
+    __m256i products = _mm256_maddubs_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(hidden)),
+                                            _mm256_load_si256(reinterpret_cast<const __m256i*>(layers.outputWeights)));
+    return layers.outputBias + horizontalSum(_mm256_madd_epi16(products, ones));
+}
+
+#endif // CHESS_X86_64
+
+} // namespace
+
+NnueNetwork::NnueNetwork()
+    : featureBias(nullptr), featureWeights(nullptr), hiddenWeights(nullptr), hiddenBias(nullptr),
+      outputWeights(nullptr), outputBias(0) {}
+
+bool NnueNetwork::load(const std::string& filename) {
+    close();
+    if (!file.open(filename)) return false;
+
+    const unsigned char* data = file.data();
+    if (file.size() != FILE_SIZE || !std::equal(MAGIC, MAGIC + 4, reinterpret_cast<const char*>(data)) ||
+        readInt32(data + 4) != VERSION || readInt32(data + 8) != NNUE_HIDDEN) {
+        close();
+        return false;
+    }
+
+    // The mapping is page aligned, so the section offsets keep the weights aligned
+    featureBias = reinterpret_cast<const int16_t*>(data + FEATURE_BIAS_OFFSET);
+    featureWeights = reinterpret_cast<const int16_t*>(data + FEATURE_WEIGHTS_OFFSET);
+    hiddenWeights = reinterpret_cast<const int8_t*>(data + HIDDEN_WEIGHTS_OFFSET);
+    hiddenBias = reinterpret_cast<const int32_t*>(data + HIDDEN_BIAS_OFFSET);
+    outputWeights = reinterpret_cast<const int8_t*>(data + OUTPUT_WEIGHTS_OFFSET);
+    outputBias = readInt32(data + OUTPUT_BIAS_OFFSET);
+    return true;
+}
+
+void NnueNetwork::close() {
+    file.close();
+    featureBias = featureWeights = nullptr;
+    hiddenWeights = outputWeights = nullptr;
+    hiddenBias = nullptr;
+    outputBias = 0;
+}
+
+int NnueNetwork::featureIndex(Color perspective, int kingSquare, Piece piece, int square) {
+    int flip = perspective == WHITE ? 0 : 56;
+    bool white = piece <= W_KING;
+    int type = (piece - 1) % 6;                          // Pawn to queen, 0-4
+    int relative = (white == (perspective == WHITE)) ? type : type + 5;
+    return ((kingSquare ^ flip) * 10 + relative) * 64 + (square ^ flip);
+}
+
+void NnueNetwork::refresh(const Piece board[64], Color perspective, NnueAccumulator& accumulator) const {
+    Piece king = perspective == WHITE ? W_KING : B_KING;
+    int kingSquare = 0;
+    for (int square = 0; square < 64; square++) {
+        if (board[square] == king) kingSquare = square;
+    }
+
+    int16_t* values = accumulator.values[perspective];
+    std::copy(featureBias, featureBias + NNUE_HIDDEN, values);
+    for (int square = 0; square < 64; square++) {
+        Piece piece = board[square];
+        if (piece == EMPTY || piece == W_KING || piece == B_KING) continue;
+        const int16_t* row = featureWeights + size_t(featureIndex(perspective, kingSquare, piece, square)) * NNUE_HIDDEN;
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            values[i] = static_cast<int16_t>(values[i] + row[i]);
+        }
+    }
+    accumulator.kingSquare[perspective] = kingSquare;
+}
+
+void NnueNetwork::update(NnueAccumulator& accumulator, Color perspective, const NnueChange* added, int addedCount,
+                         const NnueChange* removed, int removedCount) const {
+    int16_t* values = accumulator.values[perspective];
+    int kingSquare = accumulator.kingSquare[perspective];
+    for (int n = 0; n < addedCount; n++) {
+        const int16_t* row =
+            featureWeights + size_t(featureIndex(perspective, kingSquare, added[n].piece, added[n].square)) * NNUE_HIDDEN;
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            values[i] = static_cast<int16_t>(values[i] + row[i]);
+        }
+    }
+    for (int n = 0; n < removedCount; n++) {
+        const int16_t* row =
+            featureWeights + size_t(featureIndex(perspective, kingSquare, removed[n].piece, removed[n].square)) * NNUE_HIDDEN;
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            values[i] = static_cast<int16_t>(values[i] - row[i]);
+        }
+    }
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, Color sideToMove, SimdLevel level) const {
+    Layers layers = {hiddenWeights, hiddenBias, outputWeights, outputBias};
+    const int16_t* us = accumulator.values[sideToMove];
+    const int16_t* them = accumulator.values[sideToMove == WHITE ? BLACK : WHITE];
+    if (level > supportedSimdLevel()) level = supportedSimdLevel();
+
+    int32_t output;
+#ifdef CHESS_X86_64
+    if (level == SIMD_AVX2) output = propagateAvx2(us, them, layers);
+    else if (level == SIMD_SSE41) output = propagateSse41(us, them, layers);
+    else output = propagateScalar(us, them, layers);
+#else
+    output = propagateScalar(us, them, layers);
+#endif
+    return output / OUTPUT_SCALE;
+}
+
+int NnueNetwork::evaluate(const Board& board) const {
+    if (board.getNetwork() == this) {
+        return evaluate(board.getAccumulator(), board.getCurrentPlayer());
+    }
+    NnueAccumulator accumulator;
+    refresh(board.getState().board, WHITE, accumulator);
+    refresh(board.getState().board, BLACK, accumulator);
+    return evaluate(accumulator, board.getCurrentPlayer());
+}
+
+bool NnueNetwork::writeRandom(const std::string& filename, uint32_t seed) {
+    std::vector<char> data(FILE_SIZE, 0);
+    std::copy(MAGIC, MAGIC + 4, data.begin());
+    int32_t version = VERSION, hidden = NNUE_HIDDEN;
+    std::memcpy(&data[4], &version, sizeof(version));
+    std::memcpy(&data[8], &hidden, sizeof(hidden));
+
+    // Uniform in [-range, range]
+    auto next = [&seed](int range) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<int>((seed >> 16) % (2 * range + 1)) - range;
+    };
+    int16_t* bias = reinterpret_cast<int16_t*>(&data[FEATURE_BIAS_OFFSET]);
+    for (int i = 0; i < NNUE_HIDDEN; i++) bias[i] = static_cast<int16_t>(32 + next(32));
+    int16_t* weights = reinterpret_cast<int16_t*>(&data[FEATURE_WEIGHTS_OFFSET]);
+    for (size_t i = 0; i < size_t(INPUTS) * NNUE_HIDDEN; i++) weights[i] = static_cast<int16_t>(next(16));
+    int8_t* hiddenRows = reinterpret_cast<int8_t*>(&data[HIDDEN_WEIGHTS_OFFSET]);
+    for (int i = 0; i < HIDDEN2 * 2 * NNUE_HIDDEN; i++) hiddenRows[i] = static_cast<int8_t>(next(8));
+    int8_t* outputRow = reinterpret_cast<int8_t*>(&data[OUTPUT_WEIGHTS_OFFSET]);
+    for (int i = 0; i < HIDDEN2; i++) outputRow[i] = static_cast<int8_t>(next(32));
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) return false;
+    out.write(data.data(), data.size());
+    return out.good();
+}
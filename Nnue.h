@@ -0,0 +1,79 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include "Simd.h"
+#include <cstdint>
+#include <string>
+
+// A piece placed on or removed from a square, as seen by the accumulator
+struct NnueChange {
+    Piece piece;
+    int square;
+};
+
+// Efficiently updatable neural network evaluation.
+//
+// Inputs are HalfKP features: for each perspective, the perspective's king
+// square crossed with every non-king piece and its square, all mirrored
+// for black so each side sees itself as white. The first layer is the
+// accumulator (int16, NNUE_HIDDEN per perspective), followed by
+//   clamp(0..127) -> int8 dense 2*NNUE_HIDDEN x 32 -> clamp(0..127)
+//   -> int8 dense 32 x 1 -> centipawns.
+//
+// The network file is memory-mapped and used in place. Layout after a
+// 64-byte header ("CNUE", version, hidden width), little-endian:
+//   int16 featureBias[NNUE_HIDDEN]
+//   int16 featureWeights[INPUTS][NNUE_HIDDEN]
+//   int8  hiddenWeights[HIDDEN2][2 * NNUE_HIDDEN]
+//   int32 hiddenBias[HIDDEN2]
+//   int8  outputWeights[HIDDEN2]
+//   int32 outputBias
+class NnueNetwork {
+public:
+    static const int INPUTS = 64 * 10 * 64;
+    static const int HIDDEN2 = 32;
+    static const int HIDDEN_SHIFT = 6;     // Scales the hidden layer back to 0..127
+    static const int OUTPUT_SCALE = 16;    // Output units per centipawn
+    static const int VERSION = 1;
+
+private:
+    MappedFile file;
+    const int16_t* featureBias;
+    const int16_t* featureWeights;
+    const int8_t* hiddenWeights;
+    const int32_t* hiddenBias;
+    const int8_t* outputWeights;
+    int32_t outputBias;
+
+public:
+    NnueNetwork();
+
+    // Fails if the file is missing or is not a network of this shape
+    bool load(const std::string& filename);
+    void close();
+    bool isLoaded() const { return file.isOpen(); }
+
+    static int featureIndex(Color perspective, int kingSquare, Piece piece, int square);
+
+    // Recomputes one perspective from scratch; needed when its king moves
+    void refresh(const Piece board[64], Color perspective, NnueAccumulator& accumulator) const;
+    void update(NnueAccumulator& accumulator, Color perspective, const NnueChange* added, int addedCount,
+                const NnueChange* removed, int removedCount) const;
+
+    // Centipawns from the side to move's point of view; level is capped at
+    // what the CPU supports
+    int evaluate(const NnueAccumulator& accumulator, Color sideToMove, SimdLevel level) const;
+    int evaluate(const NnueAccumulator& accumulator, Color sideToMove) const {
+        return evaluate(accumulator, sideToMove, supportedSimdLevel());
+    }
+    // Uses the board's accumulator when this network is attached to it
+    int evaluate(const Board& board) const;
+
+    // Writes a network of small random weights, for tests and benchmarks;
+    // playing strength needs a trained network
+    static bool writeRandom(const std::string& filename, uint32_t seed);
+};
+
+#endif // NNUE_H
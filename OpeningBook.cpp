@@ -0,0 +1,247 @@
+#include "../include/OpeningBook.h"
+#include <algorithm>
+#include <fstream>
+
+namespace {
+
+const size_t ENTRY_SIZE = 16;
+// The keys are not Polyglot's, so neither is the file: a header with this
+// magic keeps real Polyglot books from opening and never matching
+const size_t HEADER_SIZE = 16;
+const char MAGIC[] = "CBK1";
+
+uint64_t readBigEndian(const unsigned char* bytes, int count) {
+    uint64_t value = 0;
+    for (int i = 0; i < count; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void writeBigEndian(std::ostream& out, uint64_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+} // namespace
+
+OpeningBook::OpeningBook() : entryCount(0), rng(std::random_device{}()) {}
+
+bool OpeningBook::open(const std::string& filename) {
+    entryCount = 0;
+    if (!file.open(filename)) {
+        return false;
+    }
+    if (file.size() < HEADER_SIZE || (file.size() - HEADER_SIZE) % ENTRY_SIZE != 0 ||
+        !std::equal(MAGIC, MAGIC + 4, file.data())) {
+        file.close();
+        return false;
+    }
+    entryCount = (file.size() - HEADER_SIZE) / ENTRY_SIZE;
+    return true;
+}
+
+void OpeningBook::close() {
+    file.close();
+    entryCount = 0;
+}
+
+BookEntry OpeningBook::entryAt(size_t index) const {
+    const unsigned char* bytes = file.data() + HEADER_SIZE + index * ENTRY_SIZE;
+    BookEntry entry;
+    entry.key = readBigEndian(bytes, 8);
+    entry.move = static_cast<uint16_t>(readBigEndian(bytes + 8, 2));
+    entry.weight = static_cast<uint16_t>(readBigEndian(bytes + 10, 2));
+    entry.learn = static_cast<uint32_t>(readBigEndian(bytes + 12, 4));
+    return entry;
+}
+
+size_t OpeningBook::lowerBound(uint64_t key) const {
+    size_t low = 0;
+    size_t high = entryCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (readBigEndian(file.data() + HEADER_SIZE + mid * ENTRY_SIZE, 8) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+std::vector<BookEntry> OpeningBook::probe(uint64_t key) const {
+    std::vector<BookEntry> entries;
+    if (!isOpen()) return entries;
+
+    for (size_t i = lowerBound(key); i < entryCount; i++) {
+        BookEntry entry = entryAt(i);
+        if (entry.key != key) break;
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+bool OpeningBook::pickMove(const Board& board, Move& move) {
+    std::vector<BookEntry> entries = probe(board.getHash());
+
+    std::vector<Move> candidates;
+    std::vector<uint32_t> weights;
+    uint32_t totalWeight = 0;
+    for (const BookEntry& entry : entries) {
+        Move candidate;
+        if (entry.weight > 0 && decodeMove(board, entry.move, candidate)) {
+            candidates.push_back(candidate);
+            weights.push_back(entry.weight);
+            totalWeight += entry.weight;
+        }
+    }
+    if (candidates.empty()) {
+        return false;
+    }
+
+    std::uniform_int_distribution<uint32_t> distribution(0, totalWeight - 1);
+    uint32_t pick = distribution(rng);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (pick < weights[i]) {
+            move = candidates[i];
+            return true;
+        }
+        pick -= weights[i];
+    }
+    move = candidates.back();
+    return true;
+}
+
+uint16_t OpeningBook::encodeMove(const Move& move) {
+    int to = move.to;
+    if (move.isCastling) {
+        // Polyglot stores castling as the king capturing its own rook
+        to = (move.to % 8 == 6) ? move.to + 1 : move.to - 2;
+    }
+
+    int promotion = 0;
+    switch (move.promotion) {
+        case W_KNIGHT: case B_KNIGHT: promotion = 1; break;
+        case W_BISHOP: case B_BISHOP: promotion = 2; break;
+        case W_ROOK: case B_ROOK: promotion = 3; break;
+        case W_QUEEN: case B_QUEEN: promotion = 4; break;
+        default: break;
+    }
+
+    return static_cast<uint16_t>(to | (move.from << 6) | (promotion << 12));
+}
+
+bool OpeningBook::decodeMove(const Board& board, uint16_t code, Move& move) {
+    int to = code & 0x3F;
+    int from = (code >> 6) & 0x3F;
+    int promotion = (code >> 12) & 0x7;
+
+    Piece piece = board.getPiece(from);
+    if ((piece == W_KING || piece == B_KING) && (from == 4 || from == 60)) {
+        if (to == from + 3) to = from + 2;
+        else if (to == from - 4) to = from - 2;
+    }
+
+    Color color = board.getCurrentPlayer();
+    Move candidate(from, to, piece);
+    if (promotion != 0) {
+        static const Piece whitePromotions[] = {EMPTY, W_KNIGHT, W_BISHOP, W_ROOK, W_QUEEN};
+        candidate.promotion = whitePromotions[promotion];
+        if (color == BLACK) {
+            candidate.promotion = (Piece)(candidate.promotion + 6);
+        }
+    }
+
+    // Recover the special-move flags from the legal move list
+    std::vector<Move> legalMoves = board.generateLegalMoves();
+    for (const Move& legal : legalMoves) {
+        if (legal.matches(candidate)) {
+            move = legal;
+            return true;
+        }
+    }
+    return false;
+}
+
+BookBuilder::BookBuilder(int maxPly) : maxPly(maxPly), gameCount(0) {}
+
+void BookBuilder::addGame(const PgnGame& game) {
+    int whiteScore = 1;
+    int blackScore = 1;
+    if (game.result == "1-0") {
+        whiteScore = 2;
+        blackScore = 0;
+    } else if (game.result == "0-1") {
+        whiteScore = 0;
+        blackScore = 2;
+    } else if (game.result != "1/2-1/2") {
+        return; // Unfinished games carry no information
+    }
+
+    Board board;
+    int ply = 0;
+    for (const std::string& san : game.moves) {
+        if (ply >= maxPly) break;
+
+        Move move = Notation::fromSan(board, san);
+        if (move.from == -1) break;
+
+        int score = (board.getCurrentPlayer() == WHITE) ? whiteScore : blackScore;
+        positions[board.getHash()][OpeningBook::encodeMove(move)] += score;
+
+        board.applyMove(move);
+        ply++;
+    }
+    gameCount++;
+}
+
+bool BookBuilder::addPgnFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    PgnReader reader(file);
+    PgnGame game;
+    while (reader.readGame(game)) {
+        addGame(game);
+    }
+    return true;
+}
+
+bool BookBuilder::write(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char header[HEADER_SIZE] = {};
+    std::copy(MAGIC, MAGIC + 4, header);
+    file.write(header, HEADER_SIZE);
+
+    // std::map keeps keys sorted, which is what the binary search needs
+    for (const auto& position : positions) {
+        uint32_t maxScore = 0;
+        for (const auto& move : position.second) {
+            maxScore = std::max(maxScore, move.second);
+        }
+        if (maxScore == 0) continue;
+
+        for (const auto& move : position.second) {
+            if (move.second == 0) continue;
+            uint32_t weight = move.second;
+            if (maxScore > 0xFFFF) {
+                weight = std::max<uint32_t>(1, static_cast<uint32_t>(
+                    static_cast<uint64_t>(weight) * 0xFFFF / maxScore));
+            }
+            writeBigEndian(file, position.first, 8);
+            writeBigEndian(file, move.first, 2);
+            writeBigEndian(file, weight, 2);
+            writeBigEndian(file, 0, 4);
+        }
+    }
+
+    return file.good();
+}
@@ -0,0 +1,73 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include "Pgn.h"
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// One 16-byte record of a book file, in the Polyglot record layout (stored
+// big-endian on disk)
+struct BookEntry {
+    uint64_t key;
+    uint16_t move;     // to:6 | from:6 | promotion:3, castling as king-takes-rook
+    uint16_t weight;
+    uint32_t learn;
+};
+
+// Opening book backed by a memory-mapped .cbk file: a 16-byte header
+// ("CBK1", then zeros) followed by key-sorted records. The keys come from
+// Zobrist.h, not Polyglot's Random64 table, so Polyglot .bin books are
+// refused. Lookups binary-search the mapping directly; nothing is loaded
+// up front.
+class OpeningBook {
+private:
+    MappedFile file;
+    size_t entryCount;
+    std::mt19937 rng;
+
+    BookEntry entryAt(size_t index) const;
+    size_t lowerBound(uint64_t key) const;
+
+public:
+    OpeningBook();
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    size_t size() const { return entryCount; }
+    void setSeed(unsigned int seed) { rng.seed(seed); }
+
+    std::vector<BookEntry> probe(uint64_t key) const;
+
+    // Picks a legal book move for the position, weighted by entry weight
+    bool pickMove(const Board& board, Move& move);
+
+    static uint16_t encodeMove(const Move& move);
+    static bool decodeMove(const Board& board, uint16_t code, Move& move);
+};
+
+// Accumulates move statistics from PGN games and writes a .cbk book.
+// Moves are weighted 2 per win and 1 per draw for the side that played them.
+class BookBuilder {
+private:
+    int maxPly;
+    size_t gameCount;
+    std::map<uint64_t, std::map<uint16_t, uint32_t>> positions;
+
+public:
+    explicit BookBuilder(int maxPly = 30);
+
+    void addGame(const PgnGame& game);
+    bool addPgnFile(const std::string& filename);
+    bool write(const std::string& filename) const;
+
+    size_t getGameCount() const { return gameCount; }
+    size_t getPositionCount() const { return positions.size(); }
+};
+
+#endif // OPENING_BOOK_H
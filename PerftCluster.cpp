@@ -0,0 +1,301 @@
+#include "../include/PerftCluster.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void collectUnits(Board& board, int depth, int plies, std::vector<Move>& path, std::vector<WorkUnit>& units) {
+    if (plies == 0) {
+        WorkUnit unit;
+        unit.fen = board.toFEN();
+        unit.depth = depth;
+        unit.path = path;
+        units.push_back(unit);
+        return;
+    }
+    // A branch that ends before the split contributes no leaves
+    MoveList moves;
+    board.generateLegalMoves(moves);
+    for (const Move& move : moves) {
+        board.applyMove(move);
+        path.push_back(move);
+        collectUnits(board, depth - 1, plies - 1, path, units);
+        path.pop_back();
+        board.undoMove();
+    }
+}
+
+#ifndef _WIN32
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) return false;
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+PerftCluster::PerftCluster(int workers) : workerCount(std::max(1, workers)) {}
+
+PerftCluster::~PerftCluster() {
+    stop();
+}
+
+std::vector<WorkUnit> PerftCluster::split(const Board& root, int depth, int splitPlies) {
+    Board board = root;
+    std::vector<WorkUnit> units;
+    std::vector<Move> path;
+    collectUnits(board, depth, std::max(0, std::min(splitPlies, depth - 1)), path, units);
+
+    // Largest first, with the legal move count as a cheap estimate of the
+    // subtree, so no big unit is left to start last
+    std::vector<std::pair<int, size_t>> order;
+    for (size_t i = 0; i < units.size(); i++) {
+        MoveList moves;
+        board.loadFromFEN(units[i].fen);
+        board.generateLegalMoves(moves);
+        order.push_back(std::make_pair(-moves.size(), i));
+    }
+    std::stable_sort(order.begin(), order.end());
+    std::vector<WorkUnit> sorted;
+    sorted.reserve(units.size());
+    for (const auto& entry : order) sorted.push_back(units[entry.second]);
+    return sorted;
+}
+
+std::string PerftCluster::handleUnit(const std::string& line, Search& search) {
+    std::istringstream stream(line);
+    std::string kind, fen, field;
+    int id = -1, depth = -1;
+    stream >> kind >> id >> depth;
+    for (int i = 0; i < 6 && stream >> field; i++) fen += (i ? " " : "") + field;
+
+    std::ostringstream reply;
+    reply << id;
+    Board board;
+    if (id < 0 || depth < 0 || (kind != "perft" && kind != "search") || !board.loadFromFEN(fen)) {
+        reply << " error";
+        return reply.str();
+    }
+
+    if (kind == "perft") {
+        uint64_t leaves = board.perft(depth);
+        reply << " " << leaves << " " << leaves;
+    } else if (!board.hasLegalMove()) {
+        // think() has no move to score here
+        int score = board.isInCheck(board.getCurrentPlayer()) ? -Search::MATE_SCORE : 0;
+        reply << " " << score << " 0";
+    } else {
+        // A fresh table per unit keeps scores independent of which units
+        // the worker searched before
+        search.newGame();
+        SearchLimits limits;
+        limits.depth = std::max(1, depth);
+        SearchResult result = search.think(board, limits);
+        reply << " " << result.score << " " << result.nodes;
+    }
+    return reply.str();
+}
+
+#ifdef _WIN32
+
+bool PerftCluster::start() {
+    return false;
+}
+
+void PerftCluster::stop() {}
+
+void PerftCluster::workerLoop(int) {}
+
+bool PerftCluster::dispatch(const std::string&, const std::vector<WorkUnit>&, std::vector<int64_t>&,
+                            std::vector<uint64_t>&, ClusterReport&) {
+    return false;
+}
+
+#else
+
+bool PerftCluster::start() {
+    if (!workers.empty()) return true;
+    for (int i = 0; i < workerCount; i++) {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+            stop();
+            return false;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(sockets[0]);
+            close(sockets[1]);
+            stop();
+            return false;
+        }
+        if (pid == 0) {
+            // Holding the coordinator's ends of earlier workers would keep
+            // them from seeing end of file when the coordinator stops
+            close(sockets[0]);
+            for (const Worker& worker : workers) close(worker.fd);
+            workerLoop(sockets[1]);
+            _exit(0);
+        }
+        close(sockets[1]);
+        Worker worker;
+        worker.pid = pid;
+        worker.fd = sockets[0];
+        worker.unit = -1;
+        workers.push_back(worker);
+    }
+    return true;
+}
+
+void PerftCluster::stop() {
+    // Closing a worker's socket is its signal to exit
+    for (const Worker& worker : workers) close(worker.fd);
+    for (const Worker& worker : workers) waitpid(worker.pid, nullptr, 0);
+    workers.clear();
+}
+
+void PerftCluster::workerLoop(int fd) {
+    Search search;
+    std::string pending;
+    char buffer[4096];
+    while (true) {
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count <= 0) break;
+        pending.append(buffer, static_cast<size_t>(count));
+
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!sendAll(fd, handleUnit(line, search) + "\n")) {
+                close(fd);
+                return;
+            }
+        }
+    }
+    close(fd);
+}
+
+bool PerftCluster::dispatch(const std::string& kind, const std::vector<WorkUnit>& units,
+                            std::vector<int64_t>& values, std::vector<uint64_t>& nodes, ClusterReport& report) {
+    if (!start()) return false;
+    values.assign(units.size(), 0);
+    nodes.assign(units.size(), 0);
+    report.units = units.size();
+    report.unitsPerWorker.assign(workers.size(), 0);
+
+    size_t next = 0, done = 0;
+    auto sendNext = [&](Worker& worker) {
+        worker.unit = -1;
+        if (next >= units.size()) return true;
+        std::ostringstream line;
+        line << kind << " " << next << " " << units[next].depth << " " << units[next].fen << "\n";
+        worker.unit = static_cast<int>(next++);
+        return sendAll(worker.fd, line.str());
+    };
+
+    // A worker that dies or answers out of turn leaves the cluster in an
+    // unknown state; it is restarted by the next call
+    bool ok = true;
+    for (Worker& worker : workers) ok = ok && sendNext(worker);
+
+    std::vector<pollfd> fds(workers.size());
+    while (ok && done < units.size()) {
+        for (size_t i = 0; i < workers.size(); i++) {
+            fds[i].fd = workers[i].fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+
+        for (size_t i = 0; ok && i < workers.size(); i++) {
+            if (fds[i].revents == 0) continue;
+            Worker& worker = workers[i];
+            char buffer[256];
+            ssize_t count = read(worker.fd, buffer, sizeof(buffer));
+            if (count <= 0) {
+                ok = false;
+                break;
+            }
+            worker.pending.append(buffer, static_cast<size_t>(count));
+
+            size_t newline;
+            while (ok && (newline = worker.pending.find('\n')) != std::string::npos) {
+                std::istringstream reply(worker.pending.substr(0, newline));
+                worker.pending.erase(0, newline + 1);
+                int id;
+                int64_t value;
+                uint64_t count;
+                if (!(reply >> id >> value >> count) || id != worker.unit) {
+                    ok = false;
+                    break;
+                }
+                values[id] = value;
+                nodes[id] = count;
+                done++;
+                report.unitsPerWorker[i]++;
+                ok = sendNext(worker);
+            }
+        }
+    }
+
+    if (!ok) stop();
+    return ok;
+}
+
+#endif
+
+bool PerftCluster::perft(const Board& root, int depth, int splitPlies, ClusterReport& report) {
+    auto start = std::chrono::steady_clock::now();
+    report = ClusterReport();
+    std::vector<WorkUnit> units = split(root, depth, splitPlies);
+    std::vector<int64_t> values;
+    std::vector<uint64_t> nodes;
+    if (!dispatch("perft", units, values, nodes, report)) return false;
+
+    for (uint64_t count : nodes) report.nodes += count;
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool PerftCluster::analyse(const Board& root, int depth, ClusterReport& report) {
+    auto start = std::chrono::steady_clock::now();
+    report = ClusterReport();
+    std::vector<WorkUnit> units = split(root, std::max(2, depth), 1);
+    if (units.empty()) return false;
+    std::vector<int64_t> values;
+    std::vector<uint64_t> nodes;
+    if (!dispatch("search", units, values, nodes, report)) return false;
+
+    // Each unit is scored for the opponent; a mate seen from there is one
+    // ply further from the root
+    for (size_t i = 0; i < units.size(); i++) {
+        int value = static_cast<int>(values[i]);
+        int score = -value;
+        if (Search::isMateScore(value)) score += value > 0 ? 1 : -1;
+        if (i == 0 || score > report.score) {
+            report.score = score;
+            report.bestMove = units[i].path[0];
+        }
+        report.nodes += nodes[i];
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef PERFT_CLUSTER_H
+#define PERFT_CLUSTER_H
+
+#include "Board.h"
+#include "Search.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One piece of a split tree: a position below the root and what to do
+// with it. Perft units count leaves; search units score the position for
+// the side to move.
+struct WorkUnit {
+    std::string fen;
+    int depth;
+    std::vector<Move> path;     // Moves from the root, for reporting
+};
+
+struct ClusterReport {
+    uint64_t nodes;             // Perft leaves, or search nodes summed over units
+    double seconds;
+    size_t units;
+    std::vector<size_t> unitsPerWorker;
+
+    // Analysis only: the best root move and its score for the root side
+    Move bestMove;
+    int score;
+
+    ClusterReport() : nodes(0), seconds(0.0), units(0), score(0) {}
+};
+
+// Runs perft or a root-split search on a set of worker processes on this
+// machine. Workers are forked once by start() and talk to the coordinator
+// over a Unix socket pair each, one text line per unit and per reply.
+// Units are dispatched largest first and every worker holds one unit at
+// a time, so a worker that finishes early takes the next unit instead of
+// leaving the tail to a busy one. Needs fork(); start() fails on Windows.
+class PerftCluster {
+private:
+    struct Worker {
+        int pid;
+        int fd;
+        std::string pending;    // Reply bytes read but not yet a full line
+        int unit;               // Unit in progress, -1 when idle
+    };
+
+    int workerCount;
+    std::vector<Worker> workers;
+
+    bool dispatch(const std::string& kind, const std::vector<WorkUnit>& units,
+                  std::vector<int64_t>& values, std::vector<uint64_t>& nodes, ClusterReport& report);
+    static void workerLoop(int fd);
+
+public:
+    explicit PerftCluster(int workers);
+    ~PerftCluster();
+
+    PerftCluster(const PerftCluster&) = delete;
+    PerftCluster& operator=(const PerftCluster&) = delete;
+
+    bool start();
+    void stop();
+    int size() const { return workerCount; }
+
+    // Every position splitPlies below the root as a unit of depth - splitPlies,
+    // ordered by their number of legal moves, largest first
+    static std::vector<WorkUnit> split(const Board& root, int depth, int splitPlies);
+
+    // Total perft leaf count of root at depth
+    bool perft(const Board& root, int depth, int splitPlies, ClusterReport& report);
+    // Searches every root move to depth - 1 on the workers and keeps the best
+    bool analyse(const Board& root, int depth, ClusterReport& report);
+
+    // What a worker does with one request line: "perft <id> <depth> <fen>"
+    // or "search <id> <depth> <fen>". Replies "<id> <value> <nodes>", or
+    // "<id> error" for a line it cannot read.
+    static std::string handleUnit(const std::string& line, Search& search);
+};
+
+#endif // PERFT_CLUSTER_H
@@ -0,0 +1,101 @@
+/**
+ * chess_perft - perft and root-split search on a cluster of worker processes
+ *
+ * Usage:
+ *   chess_perft [options]
+ *
+ * Options:
+ *   --fen FEN               Root position (default: the start position)
+ *   --depth D               Perft or search depth (default 5)
+ *   --workers N             Worker processes (default: all cores)
+ *   --split P               Plies below the root split into units (default 2)
+ *   --analyse               Search every root move to depth D - 1 instead of perft
+ *   --scaling               Run with 1, 2, 4... N workers and report the speedup
+ */
+
+#include "../include/PerftCluster.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+static bool runOnce(const Board& root, int workers, int depth, int split, bool analyse, ClusterReport& report) {
+    PerftCluster cluster(workers);
+    if (!cluster.start()) {
+        std::cerr << "Cannot start " << workers << " worker processes\n";
+        return false;
+    }
+    bool ok = analyse ? cluster.analyse(root, depth, report) : cluster.perft(root, depth, split, report);
+    if (!ok) std::cerr << "A worker failed\n";
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    int depth = 5;
+    int workers = ThreadPool::hardwareThreads();
+    int split = 2;
+    bool analyse = false;
+    bool scaling = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--fen" && hasValue) fen = argv[++i];
+        else if (arg == "--depth" && hasValue) depth = std::atoi(argv[++i]);
+        else if (arg == "--workers" && hasValue) workers = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--split" && hasValue) split = std::atoi(argv[++i]);
+        else if (arg == "--analyse") analyse = true;
+        else if (arg == "--scaling") scaling = true;
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    Board root;
+    if (!root.loadFromFEN(fen)) {
+        std::cerr << "Invalid FEN: " << fen << "\n";
+        return 1;
+    }
+
+    if (!scaling) {
+        ClusterReport report;
+        if (!runOnce(root, workers, depth, split, analyse, report)) return 1;
+        if (analyse) {
+            std::cout << "Best move: " << root.squareToAlgebraic(report.bestMove.from)
+                      << root.squareToAlgebraic(report.bestMove.to) << ", score " << report.score << "\n";
+        }
+        std::cout << (analyse ? "Search nodes: " : "Nodes: ") << report.nodes << "\n";
+        std::cout << "Units: " << report.units << " on " << workers << " workers\n";
+        std::cout << "Time: " << std::fixed << std::setprecision(3) << report.seconds << " s, "
+                  << static_cast<uint64_t>(report.nodes / std::max(report.seconds, 1e-9)) << " nodes/s\n";
+        return 0;
+    }
+
+    // Results must not depend on the worker count; the first run is the reference
+    double baseline = 0.0;
+    ClusterReport reference;
+    std::cout << "Workers  Seconds  Speedup  Units/worker\n";
+    for (int count = 1;; count *= 2) {
+        count = std::min(count, workers);
+        ClusterReport report;
+        if (!runOnce(root, count, depth, split, analyse, report)) return 1;
+        if (count == 1) {
+            baseline = report.seconds;
+            reference = report;
+        } else if (analyse ? report.score != reference.score : report.nodes != reference.nodes) {
+            std::cerr << "Result with " << count << " workers differs from 1 worker\n";
+            return 1;
+        }
+        auto range = std::minmax_element(report.unitsPerWorker.begin(), report.unitsPerWorker.end());
+        std::cout << std::setw(7) << count << std::setw(9) << std::fixed << std::setprecision(3) << report.seconds
+                  << std::setw(8) << std::setprecision(2) << baseline / report.seconds << "x"
+                  << std::setw(8) << *range.first << "-" << *range.second << "\n";
+        if (count == workers) break;
+    }
+    std::cout << (analyse ? "Search nodes: " : "Nodes: ") << reference.nodes << "\n";
+    return 0;
+}
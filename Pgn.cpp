@@ -0,0 +1,235 @@
+#include "../include/Pgn.h"
+#include <cctype>
+
+namespace {
+
+bool isResultToken(const std::string& token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+Piece pieceFromLetter(char letter, Color color) {
+    Piece white = EMPTY;
+    switch (letter) {
+        case 'N': white = W_KNIGHT; break;
+        case 'B': white = W_BISHOP; break;
+        case 'R': white = W_ROOK; break;
+        case 'Q': white = W_QUEEN; break;
+        case 'K': white = W_KING; break;
+        default: return EMPTY;
+    }
+    return (color == WHITE) ? white : (Piece)(white + 6);
+}
+
+} // namespace
+
+void PgnReader::skipUntil(char closing) {
+    char c;
+    while (input.get(c) && c != closing) {
+    }
+}
+
+void PgnReader::skipVariation() {
+    int depth = 1;
+    char c;
+    while (depth > 0 && input.get(c)) {
+        if (c == '(') depth++;
+        else if (c == ')') depth--;
+        else if (c == '{') skipUntil('}');
+    }
+}
+
+bool PgnReader::readToken(std::string& token) {
+    token.clear();
+    char c;
+    while (input.get(c)) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!token.empty()) return true;
+        } else if (c == '{' || c == ';' || c == '(' || c == '[') {
+            if (!token.empty()) {
+                input.unget();
+                return true;
+            }
+            if (c == '{') skipUntil('}');
+            else if (c == ';') skipUntil('\n');
+            else if (c == '(') skipVariation();
+            else {
+                token = "[";
+                return true;
+            }
+        } else {
+            token += c;
+        }
+    }
+    return !token.empty();
+}
+
+bool PgnReader::readGame(PgnGame& game) {
+    game.tags.clear();
+    game.moves.clear();
+    game.result = "*";
+
+    bool started = false;
+    std::string token;
+    while (readToken(token)) {
+        if (token == "[") {
+            // Tag pair: [Name "Value"]
+            std::string line;
+            std::getline(input, line, ']');
+            size_t space = line.find(' ');
+            size_t open = line.find('"');
+            size_t close = line.rfind('"');
+            if (space != std::string::npos && open != std::string::npos && close > open) {
+                game.tags[line.substr(0, space)] = line.substr(open + 1, close - open - 1);
+            }
+            started = true;
+            continue;
+        }
+
+        started = true;
+        if (isResultToken(token)) {
+            game.result = token;
+            return true;
+        }
+        if (token[0] == '$') {
+            continue; // NAG
+        }
+
+        // Strip move numbers ("12." or "12...") and annotation glyphs
+        size_t start = 0;
+        while (token.compare(0, 3, "0-0") != 0 && start < token.size() && (std::isdigit(static_cast<unsigned char>(token[start])) ||
+                                        token[start] == '.')) {
+            start++;
+        }
+        std::string san = token.substr(start);
+        while (!san.empty() && (san.back() == '!' || san.back() == '?')) {
+            san.pop_back();
+        }
+        if (!san.empty()) {
+            game.moves.push_back(san);
+        }
+    }
+
+    // A game without a result token at end of input still counts
+    return started;
+}
+
+Move Notation::fromSan(const Board& board, const std::string& sanInput) {
+    std::string san = sanInput;
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' ||
+                            san.back() == '!' || san.back() == '?')) {
+        san.pop_back();
+    }
+    if (san.empty()) return Move();
+
+    Color color = board.getCurrentPlayer();
+    std::vector<Move> legalMoves = board.generateLegalMoves();
+
+    // Castling
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        int toFile = (san.size() == 3) ? 6 : 2;
+        for (const Move& move : legalMoves) {
+            if (move.isCastling && move.to % 8 == toFile) {
+                return move;
+            }
+        }
+        return Move();
+    }
+
+    // Promotion suffix: "e8=Q" or "e8Q"
+    Piece promotion = EMPTY;
+    if (san.size() >= 3 && std::isupper(static_cast<unsigned char>(san.back()))) {
+        promotion = pieceFromLetter(san.back(), color);
+        san.pop_back();
+        if (!san.empty() && san.back() == '=') {
+            san.pop_back();
+        }
+        if (promotion == EMPTY || promotion == W_KING || promotion == B_KING) {
+            return Move();
+        }
+    }
+
+    Piece piece = (color == WHITE) ? W_PAWN : B_PAWN;
+    size_t pos = 0;
+    if (std::isupper(static_cast<unsigned char>(san[0]))) {
+        piece = pieceFromLetter(san[0], color);
+        if (piece == EMPTY) return Move();
+        pos = 1;
+    }
+
+    if (san.size() < pos + 2) return Move();
+    int to = board.algebraicToSquare(san.substr(san.size() - 2));
+    if (to == -1) return Move();
+
+    // Whatever remains between piece letter and destination is disambiguation
+    int fromFile = -1;
+    int fromRank = -1;
+    for (size_t i = pos; i < san.size() - 2; i++) {
+        char c = san[i];
+        if (c >= 'a' && c <= 'h') fromFile = c - 'a';
+        else if (c >= '1' && c <= '8') fromRank = c - '1';
+        else if (c != 'x') return Move();
+    }
+
+    Move found;
+    int matches = 0;
+    for (const Move& move : legalMoves) {
+        if (move.piece != piece || move.to != to || move.promotion != promotion) continue;
+        if (fromFile != -1 && move.from % 8 != fromFile) continue;
+        if (fromRank != -1 && move.from / 8 != fromRank) continue;
+        found = move;
+        matches++;
+    }
+
+    return (matches == 1) ? found : Move();
+}
+
+std::string Notation::toSan(const Board& board, const Move& move) {
+    static const char letters[] = " PNBRQKPNBRQK";
+    std::string san;
+
+    if (move.isCastling) {
+        san = (move.to % 8 == 6) ? "O-O" : "O-O-O";
+    } else {
+        bool isPawn = move.piece == W_PAWN || move.piece == B_PAWN;
+        bool isCapture = move.captured != EMPTY || move.isEnPassant;
+
+        if (isPawn) {
+            if (isCapture) san += (char)('a' + move.from % 8);
+        } else {
+            san += letters[move.piece];
+
+            // Disambiguate between identical pieces reaching the same square
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (const Move& other : board.generateLegalMoves()) {
+                if (other.piece != move.piece || other.to != move.to || other.from == move.from) continue;
+                ambiguous = true;
+                if (other.from % 8 == move.from % 8) sameFile = true;
+                if (other.from / 8 == move.from / 8) sameRank = true;
+            }
+            if (ambiguous) {
+                if (!sameFile) {
+                    san += (char)('a' + move.from % 8);
+                } else if (!sameRank) {
+                    san += (char)('1' + move.from / 8);
+                } else {
+                    san += board.squareToAlgebraic(move.from);
+                }
+            }
+        }
+
+        if (isCapture) san += 'x';
+        san += board.squareToAlgebraic(move.to);
+        if (move.promotion != EMPTY) {
+            san += '=';
+            san += letters[move.promotion];
+        }
+    }
+
+    Board after = board;
+    after.applyMove(move);
+    const PositionStatus& status = after.getStatus();
+    if (status.inCheck) {
+        san += status.hasLegalMove ? '+' : '#';
+    }
+    return san;
+}
@@ -0,0 +1,38 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include "Board.h"
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+struct PgnGame {
+    std::map<std::string, std::string> tags;
+    std::vector<std::string> moves;   // SAN, annotations stripped
+    std::string result;               // "1-0", "0-1", "1/2-1/2" or "*"
+};
+
+// Reads games one at a time from a PGN stream. Comments, NAGs and
+// variations are skipped; only the main line is returned.
+class PgnReader {
+private:
+    std::istream& input;
+
+    bool readToken(std::string& token);
+    void skipUntil(char closing);
+    void skipVariation();
+
+public:
+    explicit PgnReader(std::istream& in) : input(in) {}
+    bool readGame(PgnGame& game);
+};
+
+// Standard algebraic notation conversions
+class Notation {
+public:
+    static Move fromSan(const Board& board, const std::string& san);
+    static std::string toSan(const Board& board, const Move& move);
+};
+
+#endif // PGN_H
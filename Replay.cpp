@@ -0,0 +1,43 @@
+#include "../include/Replay.h"
+#include "../include/ThreadPool.h"
+#include <chrono>
+
+ReplayOutcome GameReplayer::replay(const ReplayGame& game, MoveFormat format) {
+    ReplayOutcome outcome;
+    Game replayed;
+    if (!game.startFen.empty() && !replayed.newGame(game.startFen)) {
+        return outcome;
+    }
+
+    outcome.movesApplied = replayed.replayMoves(game.moves, format);
+    outcome.valid = outcome.movesApplied == game.moves.size();
+    outcome.result = replayed.getResult();
+    return outcome;
+}
+
+ReplayReport GameReplayer::replayAll(const std::vector<ReplayGame>& games, MoveFormat format,
+                                     int threads, std::vector<ReplayOutcome>* outcomes) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ReplayOutcome> results(games.size());
+
+    // Games are independent, so each chunk replays its own range
+    ThreadPool pool(threads);
+    pool.parallelFor(games.size(), [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; i++) {
+            results[i] = replay(games[i], format);
+        }
+    });
+
+    ReplayReport report;
+    report.games = games.size();
+    for (const ReplayOutcome& outcome : results) {
+        report.moves += outcome.movesApplied;
+        if (!outcome.valid) report.invalidGames++;
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (outcomes != nullptr) {
+        outcomes->swap(results);
+    }
+    return report;
+}
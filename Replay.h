@@ -0,0 +1,48 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "Game.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Bulk validation of stored games, e.g. when ingesting game archives.
+// Every move gets exactly one legality check and the game-end status is
+// only computed for the final position.
+
+struct ReplayGame {
+    std::string startFen;             // Empty for the standard start
+    std::vector<std::string> moves;
+};
+
+struct ReplayOutcome {
+    bool valid;                       // Start position and every move legal
+    size_t movesApplied;
+    GameResult result;                // Status of the last position reached
+
+    ReplayOutcome() : valid(false), movesApplied(0), result(GAME_ONGOING) {}
+};
+
+struct ReplayReport {
+    size_t games;
+    size_t moves;
+    size_t invalidGames;
+    double seconds;
+
+    ReplayReport() : games(0), moves(0), invalidGames(0), seconds(0.0) {}
+
+    double gamesPerSecond() const { return seconds > 0.0 ? games / seconds : 0.0; }
+    double movesPerSecond() const { return seconds > 0.0 ? moves / seconds : 0.0; }
+};
+
+class GameReplayer {
+public:
+    static ReplayOutcome replay(const ReplayGame& game, MoveFormat format);
+
+    // Replays all games, split across threads (<= 0 uses every core).
+    // outcomes, if given, receives one entry per game in input order.
+    static ReplayReport replayAll(const std::vector<ReplayGame>& games, MoveFormat format,
+                                  int threads, std::vector<ReplayOutcome>* outcomes = nullptr);
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,488 @@
+#include "../include/Search.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Most valuable victim, least valuable attacker
+int captureScore(const Move& move) {
+    static const int values[7] = {0, 1, 3, 3, 5, 9, 10};
+    int victim = move.isEnPassant ? values[PAWN] : values[pieceType(move.captured)];
+    return victim * 16 - values[pieceType(move.piece)];
+}
+
+// Keeps history scores below the killer move bonus
+const int HISTORY_MAX = 40000;
+
+bool isTactical(const Move& move) {
+    return move.captured != EMPTY || move.isEnPassant || move.promotion != EMPTY;
+}
+
+} // namespace
+
+bool EngineConfig::setOption(const std::string& option, const std::string& value) {
+    bool enabled = value == "1" || value == "true" || value == "on";
+    if (option == "name") {
+        name = value;
+    } else if (option == "hash") {
+        hashMb = std::max(1, std::atoi(value.c_str()));
+    } else if (option == "tt") {
+        useTranspositionTable = enabled;
+    } else if (option == "qs") {
+        useQuiescence = enabled;
+    } else if (option == "killers") {
+        useKillers = enabled;
+    } else if (option == "pvs") {
+        usePvs = enabled;
+    } else if (option == "aspiration") {
+        useAspiration = enabled;
+    } else if (option == "evalfile") {
+        evalFile = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool EngineConfig::setOptions(const std::string& options, std::string& failedItem) {
+    std::istringstream stream(options);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos || !setOption(item.substr(0, equals), item.substr(equals + 1))) {
+            failedItem = item;
+            return false;
+        }
+    }
+    return true;
+}
+
+Search::Search(const EngineConfig& config)
+    : config(config), tt(config.hashMb), hardLimitMs(0), nextTimeCheck(0),
+      stopRequested(false), ponderHitRequested(false), pondering(false), stopped(false), nodes(0),
+      stack(MAX_PLY), rootLines(MAX_MULTI_PV) {
+    if (!config.evalFile.empty()) network.load(config.evalFile);
+    // Room for long games plus the search itself
+    board.reserveHistory(1024);
+    newGame();
+}
+
+void Search::newGame() {
+    tt.clear();
+    for (int ply = 0; ply < MAX_PLY; ply++) {
+        killers[ply][0] = Move();
+        killers[ply][1] = Move();
+    }
+    std::fill(&history[0][0][0], &history[0][0][0] + 2 * 64 * 64, 0);
+}
+
+void Search::clearSignals() {
+    stopRequested = false;
+    ponderHitRequested = false;
+}
+
+int Search::scoreToTT(int score, int ply) {
+    // Store mate scores relative to this node rather than the root
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+
+int Search::scoreFromTT(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
+int Search::elapsedMs() const {
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+bool Search::shouldStop() {
+    if (stopped) return true;
+    if (stopRequested) {
+        stopped = true;
+    } else if (pondering) {
+        // Limits do not apply until the opponent plays the expected move;
+        // the move's time budget starts then
+        if (ponderHitRequested) {
+            pondering = false;
+            startTime = std::chrono::steady_clock::now();
+            nextTimeCheck = nodes + 16;
+        }
+    } else if (limits.nodes != 0 && nodes >= limits.nodes) {
+        stopped = true;
+    } else if (hardLimitMs != 0 && nodes >= nextTimeCheck) {
+        auto elapsed = std::chrono::steady_clock::now() - startTime;
+        double elapsedMs = std::chrono::duration<double, std::milli>(elapsed).count();
+        if (elapsedMs >= hardLimitMs) {
+            stopped = true;
+        } else {
+            // Poll the clock about once a millisecond at the measured node rate
+            uint64_t nodesPerMs = elapsedMs > 0.0 ? static_cast<uint64_t>(nodes / elapsedMs) : 0;
+            nextTimeCheck = nodes + std::max<uint64_t>(16, std::min<uint64_t>(nodesPerMs, 4096));
+        }
+    }
+    return stopped;
+}
+
+void Search::orderMoves(PlyStack& entry, uint16_t ttMove, int ply) const {
+    MoveList& moves = entry.moves;
+    int* scores = entry.scores;
+    for (int i = 0; i < moves.size(); i++) {
+        const Move& move = moves[i];
+        if (TranspositionTable::samePacked(ttMove, move)) {
+            scores[i] = 1000000;
+        } else if (isTactical(move)) {
+            scores[i] = 100000 + captureScore(move) + (move.promotion != EMPTY ? 500 : 0);
+        } else if (config.useKillers && ply < MAX_PLY &&
+                   (killers[ply][0].matches(move) || killers[ply][1].matches(move))) {
+            scores[i] = 50000;
+        } else {
+            scores[i] = history[board.getCurrentPlayer()][move.from][move.to];
+        }
+    }
+
+    // Insertion sort: move lists are short and mostly need few swaps
+    for (int i = 1; i < moves.size(); i++) {
+        Move move = moves[i];
+        int score = scores[i];
+        int j = i;
+        while (j > 0 && scores[j - 1] < score) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+            j--;
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
+
+void Search::generateMoves(MoveList& moves, GenType type) {
+    SEARCH_TIMER(stats.moveGenNanos);
+    board.generateLegalMoves(moves, type);
+}
+
+int Search::evaluate() {
+    SEARCH_TIMER(stats.evalNanos);
+    if (network.isLoaded()) return network.evaluate(board.getAccumulator(), board.getCurrentPlayer());
+    return Evaluator::evaluate(board);
+}
+
+int Search::quiescence(int ply, int alpha, int beta) {
+    stack[ply].pvLength = 0;
+    nodes++;
+    SEARCH_STAT(stats.qnodes++);
+    if (shouldStop()) return 0;
+
+    int standPat = evaluate();
+    if (ply >= MAX_PLY - 1) return standPat;
+    if (standPat >= beta) return standPat;
+    if (standPat > alpha) alpha = standPat;
+
+    MoveList& moves = stack[ply].moves;
+    generateMoves(moves, GEN_CAPTURES);
+    orderMoves(stack[ply], 0, ply);
+
+    for (const Move& move : moves) {
+        board.applyMove(move);
+        int score = -quiescence(ply + 1, -beta, -alpha);
+        board.undoMove();
+
+        if (stopped) return 0;
+        if (score >= beta) return score;
+        if (score > alpha) alpha = score;
+    }
+    return alpha;
+}
+
+void Search::updatePv(int ply, const Move& move) {
+    PlyStack& entry = stack[ply];
+    const PlyStack& child = stack[ply + 1];
+    entry.pv[0] = move;
+    for (int i = 0; i < child.pvLength; i++) {
+        entry.pv[i + 1] = child.pv[i];
+    }
+    entry.pvLength = child.pvLength + 1;
+}
+
+int Search::negamax(int depth, int ply, int alpha, int beta) {
+    stack[ply].pvLength = 0;
+    if (ply > 0) {
+        if (board.isDraw() || board.isRepetition()) return 0;
+        if (ply >= MAX_PLY - 1) return evaluate();
+    }
+
+    if (depth <= 0) {
+        return config.useQuiescence ? quiescence(ply, alpha, beta) : evaluate();
+    }
+
+    nodes++;
+    SEARCH_STAT(stats.nodes++);
+    if (shouldStop()) return 0;
+
+    uint64_t key = board.getHash();
+    uint16_t ttMove = 0;
+    TTEntry entry;
+    SEARCH_STAT(if (config.useTranspositionTable) stats.ttProbes++);
+    if (config.useTranspositionTable && tt.probe(key, entry)) {
+        SEARCH_STAT(stats.ttHits++);
+        ttMove = entry.move;
+        if (ply > 0 && entry.depth >= depth) {
+            int score = scoreFromTT(entry.score, ply);
+            if (entry.bound == BOUND_EXACT ||
+                (entry.bound == BOUND_LOWER && score >= beta) ||
+                (entry.bound == BOUND_UPPER && score <= alpha)) {
+                SEARCH_STAT(stats.ttCutoffs++);
+                return score;
+            }
+        }
+    }
+
+    MoveList& moves = stack[ply].moves;
+    generateMoves(moves);
+    if (moves.empty()) {
+        return board.isInCheck(board.getCurrentPlayer()) ? -MATE_SCORE + ply : 0;
+    }
+    orderMoves(stack[ply], ttMove, ply);
+
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove;
+    for (int moveIndex = 0; moveIndex < moves.size(); moveIndex++) {
+        const Move& move = moves[moveIndex];
+        board.applyMove(move);
+        int score;
+        if (moveIndex == 0 || !config.usePvs) {
+            score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            // Later moves only have to be proven worse than the best so far;
+            // one that is not gets searched again with the full window
+            SEARCH_STAT(stats.nullWindowSearches++);
+            score = -negamax(depth - 1, ply + 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta && !stopped) {
+                SEARCH_STAT(stats.pvsResearches++);
+                score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+            }
+        }
+        board.undoMove();
+
+        if (stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        if (score > alpha) {
+            alpha = score;
+            updatePv(ply, move);
+        }
+        if (alpha >= beta) {
+            SEARCH_STAT(stats.betaCutoffs++);
+            SEARCH_STAT(stats.cutoffIndex[std::min<int>(moveIndex, SearchStats::CUTOFF_BUCKETS - 1)]++);
+            if (!isTactical(move)) {
+                if (config.useKillers && !killers[ply][0].matches(move)) {
+                    killers[ply][1] = killers[ply][0];
+                    killers[ply][0] = move;
+                }
+                int& entry = history[board.getCurrentPlayer()][move.from][move.to];
+                entry = std::min(entry + depth * depth, HISTORY_MAX);
+            }
+            break;
+        }
+    }
+
+    if (config.useTranspositionTable) {
+        BoundType bound = bestScore >= beta ? BOUND_LOWER
+                        : bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+        tt.store(key, TranspositionTable::packMove(bestMove), scoreToTT(bestScore, ply), depth, bound);
+    }
+    return bestScore;
+}
+
+// One pass over the root moves within (alpha, beta); returns the best score.
+// Only moves that beat alpha and the weakest of the best multiPv lines get a
+// line. A score of beta or more ends the pass: the window failed high.
+int Search::searchRoot(int depth, int alpha, int beta, int multiPv, int& lineCount) {
+    lineCount = 0;
+    int bestScore = -INFINITE_SCORE;
+    for (const Move& move : stack[0].moves) {
+        int floor = lineCount < multiPv ? alpha : std::max(alpha, rootLines[multiPv - 1].score);
+        board.applyMove(move);
+        int score;
+        if (lineCount < multiPv || !config.usePvs) {
+            score = -negamax(depth - 1, 1, -beta, -floor);
+        } else {
+            SEARCH_STAT(stats.nullWindowSearches++);
+            score = -negamax(depth - 1, 1, -floor - 1, -floor);
+            if (score > floor && score < beta && !stopped) {
+                SEARCH_STAT(stats.pvsResearches++);
+                score = -negamax(depth - 1, 1, -beta, -floor);
+            }
+        }
+        board.undoMove();
+        if (stopped) break;
+
+        bestScore = std::max(bestScore, score);
+        if (score > floor) {
+            insertRootLine(move, score, lineCount, multiPv);
+        }
+        if (score >= beta) break;
+    }
+    return bestScore;
+}
+
+void Search::insertRootLine(const Move& move, int score, int& lineCount, int maxLines) {
+    // Keep the lines sorted; on equal scores the earlier move stays ahead
+    int position = 0;
+    while (position < lineCount && rootLines[position].score >= score) {
+        position++;
+    }
+    if (position >= maxLines) return;
+
+    if (lineCount < maxLines) lineCount++;
+    for (int i = lineCount - 1; i > position; i--) {
+        rootLines[i] = rootLines[i - 1];
+    }
+
+    RootLine& line = rootLines[position];
+    const PlyStack& child = stack[1];
+    line.score = score;
+    line.pv[0] = move;
+    for (int i = 0; i < child.pvLength; i++) {
+        line.pv[i + 1] = child.pv[i];
+    }
+    line.pvLength = child.pvLength + 1;
+}
+
+void Search::publishLines(SearchResult& result, int lineCount) const {
+    result.lines.resize(lineCount);
+    for (int i = 0; i < lineCount; i++) {
+        const RootLine& line = rootLines[i];
+        result.lines[i].score = line.score;
+        result.lines[i].moves.assign(line.pv, line.pv + line.pvLength);
+    }
+    result.bestMove = rootLines[0].pv[0];
+    result.score = rootLines[0].score;
+}
+
+SearchResult Search::think(const Board& position, const SearchLimits& searchLimits) {
+    board = position;
+    board.setNetwork(network.isLoaded() ? &network : nullptr);
+    limits = searchLimits;
+    startTime = std::chrono::steady_clock::now();
+    if (!limits.ponder) clearSignals();
+    pondering = limits.ponder;
+    stopped = false;
+    nodes = 0;
+    nextTimeCheck = 16;
+    timeManager.init(limits, board.getCurrentPlayer());
+    hardLimitMs = limits.moveTimeMs;
+    if (timeManager.isActive() && (hardLimitMs == 0 || timeManager.maximum() < hardLimitMs)) {
+        hardLimitMs = timeManager.maximum();
+    }
+    stats.clear();
+    SEARCH_STAT(stats.searches = 1);
+
+    // Keep the history from earlier moves but let it fade
+    for (int color = 0; color < 2; color++) {
+        for (int from = 0; from < 64; from++) {
+            for (int to = 0; to < 64; to++) {
+                history[color][from][to] /= 2;
+            }
+        }
+    }
+    SEARCH_STAT(SearchStats::current() = &stats);
+
+    SearchResult result;
+    MoveList& rootMoves = stack[0].moves;
+    board.generateLegalMoves(rootMoves);
+    if (rootMoves.empty()) {
+        SEARCH_STAT(SearchStats::current() = nullptr);
+        return result;
+    }
+    result.bestMove = rootMoves[0];
+
+    int maxDepth = std::min(limits.depth, MAX_PLY - 1);
+    int multiPv = std::max(1, std::min(limits.multiPv, static_cast<int>(MAX_MULTI_PV)));
+    int wantedLines = std::min(multiPv, rootMoves.size());
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        SEARCH_STAT(uint64_t nodesBefore = nodes);
+        orderMoves(stack[0], TranspositionTable::packMove(result.bestMove), 0);
+
+        // Aspiration window around the last score, widened on the side that
+        // failed until the score falls inside. MultiPV needs exact scores
+        // for every line, so it always searches the full window.
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -INFINITE_SCORE, beta = INFINITE_SCORE;
+        if (config.useAspiration && multiPv == 1 && depth >= ASPIRATION_DEPTH && !isMateScore(result.score)) {
+            alpha = std::max(result.score - delta, -INFINITE_SCORE);
+            beta = std::min(result.score + delta, static_cast<int>(INFINITE_SCORE));
+        }
+        int lineCount = 0;
+        while (true) {
+            SEARCH_STAT(if (beta - alpha < 2 * INFINITE_SCORE) stats.aspirationSearches++);
+            int score = searchRoot(depth, alpha, beta, multiPv, lineCount);
+            if (stopped) break;
+            if (score <= alpha) {
+                SEARCH_STAT(stats.aspirationFailLows++);
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -INFINITE_SCORE);
+            } else if (score >= beta) {
+                SEARCH_STAT(stats.aspirationFailHighs++);
+                beta = std::min(score + delta, static_cast<int>(INFINITE_SCORE));
+                // The move that failed high is searched first next time
+                orderMoves(stack[0], TranspositionTable::packMove(rootLines[0].pv[0]), 0);
+            } else {
+                break;
+            }
+            delta *= 2;
+        }
+
+        // A partial iteration still improves on the previous one if it
+        // already has every line, its first move being the previous best
+        Move previousBest = result.bestMove;
+        if (lineCount >= wantedLines) {
+            publishLines(result, lineCount);
+        }
+        if (stopped) break;
+
+        result.depth = depth;
+        SEARCH_STAT(stats.iterationNodes[depth] = nodes - nodesBefore);
+        if (config.useTranspositionTable) {
+            tt.store(board.getHash(), TranspositionTable::packMove(result.bestMove),
+                     result.score, depth, BOUND_EXACT);
+        }
+
+        // No point searching deeper once a forced mate is found
+        if (multiPv == 1 && isMateScore(result.score) && MATE_SCORE - std::abs(result.score) <= depth) break;
+
+        if (!pondering &&
+            timeManager.iterationDone(elapsedMs(), depth > 1 && !previousBest.matches(result.bestMove),
+                                      result.score)) {
+            break;
+        }
+    }
+
+    // A ponder search may not return before the opponent has moved
+    while (pondering && !stopRequested && !ponderHitRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pondering = false;
+
+    if (result.lines.empty()) {
+        PvLine line;
+        line.score = result.score;
+        line.moves.assign(1, result.bestMove);
+        result.lines.push_back(line);
+    }
+    result.pv = result.lines[0].moves;
+
+    SEARCH_STAT(SearchStats::current() = nullptr);
+    result.nodes = nodes;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
@@ -0,0 +1,162 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "Board.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include "SearchStats.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SearchLimits {
+    int depth;              // Maximum iteration depth
+    uint64_t nodes;         // 0 = unlimited
+    int moveTimeMs;         // 0 = unlimited
+    int multiPv;            // Number of best root moves to report
+
+    // Clock, indexed by Color; the time manager budgets the move from these
+    int timeMs[2];          // Remaining time, 0 = no clock
+    int incrementMs[2];
+    int movesToGo;          // Until the next time control, 0 = sudden death
+
+    // Search the position with no time limit until ponderhit() or stop().
+    // The caller must clearSignals() before starting a ponder search.
+    bool ponder;
+
+    SearchLimits() : depth(64), nodes(0), moveTimeMs(0), multiPv(1), movesToGo(0), ponder(false) {
+        timeMs[WHITE] = timeMs[BLACK] = 0;
+        incrementMs[WHITE] = incrementMs[BLACK] = 0;
+    }
+};
+
+struct PvLine {
+    int score;
+    std::vector<Move> moves;    // Starts with the root move
+};
+
+struct SearchResult {
+    Move bestMove;
+    int score;              // Centipawns from the side to move's point of view
+    int depth;              // Last completed iteration
+    uint64_t nodes;
+    double seconds;
+    std::vector<Move> pv;
+    std::vector<PvLine> lines;  // MultiPV lines, best first; lines[0] is the pv
+
+    SearchResult() : score(0), depth(0), nodes(0), seconds(0.0) {}
+};
+
+// Options that distinguish one engine configuration from another,
+// e.g. for self-play A/B matches
+struct EngineConfig {
+    std::string name;
+    int hashMb;
+    bool useTranspositionTable;
+    bool useQuiescence;
+    bool useKillers;
+    bool usePvs;            // Null-window searches for all but the first move
+    bool useAspiration;     // Root window around the previous iteration's score; off
+                            // until it is tuned to save nodes
+    std::string evalFile;   // NNUE network; empty or unloadable = classical evaluation
+
+    EngineConfig() : name("engine"), hashMb(16), useTranspositionTable(true),
+                     useQuiescence(true), useKillers(true), usePvs(true), useAspiration(false) {}
+
+    // Sets an option by name ("name", "hash", "tt", "qs", "killers", "pvs",
+    // "aspiration", "evalfile")
+    bool setOption(const std::string& option, const std::string& value);
+    // Comma-separated name=value pairs, e.g. "hash=64,pvs=0". Stops at the
+    // first item it cannot set and returns it in failedItem.
+    bool setOptions(const std::string& options, std::string& failedItem);
+};
+
+// Iterative deepening alpha-beta search over a private copy of the board.
+// One Search object is used by one thread at a time.
+class Search {
+public:
+    static const int MAX_PLY = 64;
+    static const int INFINITE_SCORE = 32000;
+    static const int MATE_SCORE = 31000;
+    static const int MATE_BOUND = MATE_SCORE - MAX_PLY;
+    static const int MAX_MULTI_PV = 32;
+    static const int ASPIRATION_DEPTH = 4;     // First iteration with a narrow window
+    static const int ASPIRATION_WINDOW = 25;   // Initial half-width, doubled on each failure
+
+private:
+    // Scratch memory for one ply, allocated once with the Search so the
+    // steady state of a search makes no heap allocations
+    struct PlyStack {
+        MoveList moves;
+        int scores[MoveList::CAPACITY];
+        Move pv[MAX_PLY];           // Triangular PV table row for this ply
+        int pvLength;
+    };
+
+    struct RootLine {
+        int score;
+        Move pv[MAX_PLY];
+        int pvLength;
+    };
+
+    EngineConfig config;
+    TranspositionTable tt;
+    NnueNetwork network;
+    Board board;
+    SearchLimits limits;
+    TimeManager timeManager;
+    std::chrono::steady_clock::time_point startTime;
+    int hardLimitMs;                // 0 = none
+    uint64_t nextTimeCheck;         // Node count of the next clock poll
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> ponderHitRequested;
+    bool pondering;
+    bool stopped;
+    uint64_t nodes;
+    Move killers[MAX_PLY][2];
+    int history[2][64][64];         // Quiet move cutoffs by color, from, to
+    std::vector<PlyStack> stack;    // MAX_PLY entries; ply 0 holds the root moves
+    std::vector<RootLine> rootLines;    // MAX_MULTI_PV entries, best first
+    SearchStats stats;
+
+    int negamax(int depth, int ply, int alpha, int beta);
+    int quiescence(int ply, int alpha, int beta);
+    int searchRoot(int depth, int alpha, int beta, int multiPv, int& lineCount);
+    void generateMoves(MoveList& moves, GenType type = GEN_ALL);
+    int evaluate();
+    void orderMoves(PlyStack& entry, uint16_t ttMove, int ply) const;
+    bool shouldStop();
+    int elapsedMs() const;
+    void updatePv(int ply, const Move& move);
+    void insertRootLine(const Move& move, int score, int& lineCount, int maxLines);
+    void publishLines(SearchResult& result, int lineCount) const;
+
+    static int scoreToTT(int score, int ply);
+    static int scoreFromTT(int score, int ply);
+
+public:
+    explicit Search(const EngineConfig& config = EngineConfig());
+
+    // The transposition table, killers and history carry over from one
+    // think() to the next until newGame()
+    SearchResult think(const Board& position, const SearchLimits& limits);
+    void stop() { stopRequested = true; }
+    // The expected move was played: a ponder search continues as a normal
+    // timed search from this moment
+    void ponderhit() { ponderHitRequested = true; }
+    void clearSignals();
+    void newGame();
+
+    const EngineConfig& getConfig() const { return config; }
+    bool usesNnue() const { return network.isLoaded(); }
+    // Counters of the last think() call; all zero unless built with CHESS_SEARCH_STATS
+    const SearchStats& getStats() const { return stats; }
+
+    static bool isMateScore(int score) { return score >= MATE_BOUND || score <= -MATE_BOUND; }
+};
+
+#endif // SEARCH_H
@@ -0,0 +1,113 @@
+#include "../include/SearchStats.h"
+#include <iomanip>
+#include <sstream>
+
+void SearchStats::clear() {
+    nodes = qnodes = 0;
+    ttProbes = ttHits = ttCutoffs = 0;
+    betaCutoffs = 0;
+    for (int i = 0; i < CUTOFF_BUCKETS; i++) cutoffIndex[i] = 0;
+    for (int i = 0; i < MAX_DEPTH; i++) iterationNodes[i] = 0;
+    nullWindowSearches = pvsResearches = 0;
+    aspirationSearches = aspirationFailLows = aspirationFailHighs = 0;
+    searches = 0;
+    moveGenNanos = legalityNanos = evalNanos = 0;
+}
+
+void SearchStats::merge(const SearchStats& other) {
+    nodes += other.nodes;
+    qnodes += other.qnodes;
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    ttCutoffs += other.ttCutoffs;
+    betaCutoffs += other.betaCutoffs;
+    for (int i = 0; i < CUTOFF_BUCKETS; i++) cutoffIndex[i] += other.cutoffIndex[i];
+    for (int i = 0; i < MAX_DEPTH; i++) iterationNodes[i] += other.iterationNodes[i];
+    nullWindowSearches += other.nullWindowSearches;
+    pvsResearches += other.pvsResearches;
+    aspirationSearches += other.aspirationSearches;
+    aspirationFailLows += other.aspirationFailLows;
+    aspirationFailHighs += other.aspirationFailHighs;
+    searches += other.searches;
+    moveGenNanos += other.moveGenNanos;
+    legalityNanos += other.legalityNanos;
+    evalNanos += other.evalNanos;
+}
+
+bool SearchStats::enabled() {
+#ifdef CHESS_SEARCH_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+SearchStats*& SearchStats::current() {
+    static thread_local SearchStats* stats = nullptr;
+    return stats;
+}
+
+std::string SearchStats::quoteJson(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string SearchStats::toJson() const {
+    auto ratio = [](uint64_t part, uint64_t whole) {
+        return whole == 0 ? 0.0 : static_cast<double>(part) / static_cast<double>(whole);
+    };
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"enabled\": " << (enabled() ? "true" : "false") << ",\n";
+    out << "  \"searches\": " << searches << ",\n";
+    out << "  \"nodes\": " << nodes << ",\n";
+    out << "  \"qnodes\": " << qnodes << ",\n";
+    out << "  \"tt\": {\"probes\": " << ttProbes << ", \"hits\": " << ttHits
+        << ", \"cutoffs\": " << ttCutoffs << ", \"hitRate\": " << ratio(ttHits, ttProbes)
+        << ", \"cutoffRate\": " << ratio(ttCutoffs, ttProbes) << "},\n";
+
+    out << "  \"betaCutoffs\": " << betaCutoffs << ",\n";
+    out << "  \"cutoffIndex\": [";
+    for (int i = 0; i < CUTOFF_BUCKETS; i++) {
+        out << (i ? ", " : "") << cutoffIndex[i];
+    }
+    out << "],\n";
+    out << "  \"firstMoveCutoffRate\": " << ratio(cutoffIndex[0], betaCutoffs) << ",\n";
+    out << "  \"pvs\": {\"nullWindow\": " << nullWindowSearches << ", \"researches\": " << pvsResearches
+        << ", \"researchRate\": " << ratio(pvsResearches, nullWindowSearches) << "},\n";
+    out << "  \"aspiration\": {\"searches\": " << aspirationSearches << ", \"failLows\": " << aspirationFailLows
+        << ", \"failHighs\": " << aspirationFailHighs
+        << ", \"failLowRate\": " << ratio(aspirationFailLows, aspirationSearches)
+        << ", \"failHighRate\": " << ratio(aspirationFailHighs, aspirationSearches) << "},\n";
+
+    // Effective branching factor between consecutive iterations
+    int lastDepth = 0;
+    for (int d = 1; d < MAX_DEPTH; d++) {
+        if (iterationNodes[d] != 0) lastDepth = d;
+    }
+    out << "  \"depths\": [";
+    for (int d = 1; d <= lastDepth; d++) {
+        out << (d > 1 ? ",\n    " : "\n    ") << "{\"depth\": " << d
+            << ", \"nodes\": " << iterationNodes[d] << ", \"branchingFactor\": "
+            << (d > 1 ? ratio(iterationNodes[d], iterationNodes[d - 1]) : 0.0) << "}";
+    }
+    out << (lastDepth > 0 ? "\n  ],\n" : "],\n");
+
+    out << "  \"timeMs\": {\"moveGen\": " << moveGenNanos / 1e6
+        << ", \"legality\": " << legalityNanos / 1e6
+        << ", \"eval\": " << evalNanos / 1e6 << "}\n";
+    out << "}\n";
+    return out.str();
+}
@@ -0,0 +1,75 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Search instrumentation. Counting is compiled in only when
+// CHESS_SEARCH_STATS is defined (cmake -DCHESS_SEARCH_STATS=ON); otherwise
+// the SEARCH_STAT and SEARCH_TIMER macros expand to nothing.
+#ifdef CHESS_SEARCH_STATS
+#define SEARCH_STAT(statement) statement
+#define SEARCH_TIMER_CONCAT(a, b) a##b
+#define SEARCH_TIMER_NAME(line) SEARCH_TIMER_CONCAT(searchTimer, line)
+#define SEARCH_TIMER(counter) StatTimer SEARCH_TIMER_NAME(__LINE__)(counter)
+#else
+#define SEARCH_STAT(statement)
+#define SEARCH_TIMER(counter)
+#endif
+
+// Counters for one search thread. Aligned to a cache line so that
+// counters of different threads never share one.
+struct alignas(64) SearchStats {
+    static const int CUTOFF_BUCKETS = 8;   // Last bucket collects index >= 7
+    static const int MAX_DEPTH = 64;
+
+    uint64_t nodes;
+    uint64_t qnodes;
+    uint64_t ttProbes;
+    uint64_t ttHits;
+    uint64_t ttCutoffs;
+    uint64_t betaCutoffs;
+    uint64_t cutoffIndex[CUTOFF_BUCKETS];
+    uint64_t iterationNodes[MAX_DEPTH];    // Nodes spent completing each depth
+    uint64_t nullWindowSearches;           // PVS scout searches of non-first moves
+    uint64_t pvsResearches;                // Scouts that beat alpha and were searched again
+    uint64_t aspirationSearches;           // Root passes with a narrow window
+    uint64_t aspirationFailLows;
+    uint64_t aspirationFailHighs;
+    uint64_t searches;
+
+    // Nanoseconds; legality checks run inside move generation
+    uint64_t moveGenNanos;
+    uint64_t legalityNanos;
+    uint64_t evalNanos;
+
+    SearchStats() { clear(); }
+
+    void clear();
+    void merge(const SearchStats& other);
+    std::string toJson() const;
+    // text as a JSON string literal, for output written around toJson()
+    static std::string quoteJson(const std::string& text);
+
+    static bool enabled();
+
+    // Stats of the search running on this thread, for code outside Search
+    static SearchStats*& current();
+};
+
+// Adds the lifetime of the scope to a nanosecond counter
+class StatTimer {
+private:
+    uint64_t& counter;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit StatTimer(uint64_t& target) : counter(target), start(std::chrono::steady_clock::now()) {}
+    ~StatTimer() {
+        counter += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+};
+
+#endif // SEARCH_STATS_H
@@ -0,0 +1,189 @@
+/**
+ * chess_selfplay - play matches between two engine configurations
+ *
+ * Usage:
+ *   chess_selfplay [options]
+ *
+ * Options:
+ *   --games N               Number of games (default 100)
+ *   --concurrency N         Games played in parallel (default 1); with --tc,
+ *                           at most one per hardware thread
+ *   --depth D | --nodes N | --movetime MS   Per-move limit
+ *   --tc [MOVES/]BASE[+INC] Game clock in seconds, e.g. 1+0.01 or 40/60
+ *   --engineA opts          Comma-separated options, e.g. name=base,hash=32,qs=0
+ *   --engineB opts
+ *   --openings FILE         FEN or EPD positions, one per line
+ *   --pgn FILE              Write all games as PGN
+ *   --stats FILE            Write search statistics as JSON (needs CHESS_SEARCH_STATS)
+ *   --tb DIR                Adjudicate with endgame tablebases
+ *   --resign SCORE MOVES    Resign adjudication (0 moves disables)
+ *   --draw SCORE MOVES PLY  Draw adjudication after PLY (0 moves disables)
+ *   --maxplies N            Declare a draw after N plies
+ *   --sprt ELO0 ELO1        Stop early once the SPRT accepts H0 or H1
+ *   --alpha A --beta B      SPRT error rates (default 0.05)
+ */
+
+#include "../include/Match.h"
+#include "../include/Tablebase.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+static bool parseEngineOptions(const std::string& text, EngineConfig& config) {
+    std::string item;
+    if (config.setOptions(text, item)) return true;
+    std::cerr << "Unknown engine option: " << item << "\n";
+    return false;
+}
+
+static bool loadOpenings(const std::string& filename, std::vector<std::string>& openings) {
+    std::ifstream file(filename);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        // EPD lines carry opcodes after the four position fields
+        std::istringstream fields(line);
+        std::string placement, side, castling, enPassant;
+        if (!(fields >> placement >> side >> castling >> enPassant)) continue;
+        openings.push_back(placement + " " + side + " " + castling + " " + enPassant);
+    }
+    return true;
+}
+
+static void printStats(const MatchStats& stats, const MatchSettings& settings) {
+    std::cout << "Games " << stats.games() << ": +" << stats.wins << " =" << stats.draws
+              << " -" << stats.losses << std::fixed << std::setprecision(1)
+              << "  Elo " << stats.elo() << " +/- " << stats.eloError();
+    if (settings.sprt) {
+        double lower, upper;
+        MatchRunner::sprtBounds(settings.alpha, settings.beta, lower, upper);
+        std::cout << std::setprecision(2) << "  LLR " << stats.llr(settings.elo0, settings.elo1)
+                  << " [" << lower << ", " << upper << "]";
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    MatchSettings settings;
+    settings.limits.depth = 4;
+    std::string pgnFile, openingsFile, tablebaseDir, statsFile;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue) settings.games = std::atoi(argv[++i]);
+        else if (arg == "--concurrency" && hasValue) settings.concurrency = std::atoi(argv[++i]);
+        else if (arg == "--depth" && hasValue) settings.limits.depth = std::atoi(argv[++i]);
+        else if (arg == "--nodes" && hasValue) {
+            settings.limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+            settings.limits.depth = Search::MAX_PLY;
+        } else if (arg == "--movetime" && hasValue) {
+            settings.limits.moveTimeMs = std::atoi(argv[++i]);
+            settings.limits.depth = Search::MAX_PLY;
+        } else if (arg == "--tc" && hasValue) {
+            if (!TimeControl::parse(argv[++i], settings.timeControl)) {
+                std::cerr << "Bad time control: " << argv[i] << "\n";
+                return 1;
+            }
+            settings.limits.depth = Search::MAX_PLY;
+        } else if (arg == "--engineA" && hasValue) {
+            if (!parseEngineOptions(argv[++i], settings.engines[0])) return 1;
+        } else if (arg == "--engineB" && hasValue) {
+            if (!parseEngineOptions(argv[++i], settings.engines[1])) return 1;
+        } else if (arg == "--openings" && hasValue) openingsFile = argv[++i];
+        else if (arg == "--pgn" && hasValue) pgnFile = argv[++i];
+        else if (arg == "--stats" && hasValue) statsFile = argv[++i];
+        else if (arg == "--tb" && hasValue) tablebaseDir = argv[++i];
+        else if (arg == "--maxplies" && hasValue) settings.maxPlies = std::atoi(argv[++i]);
+        else if (arg == "--resign" && i + 2 < argc) {
+            settings.resignScore = std::atoi(argv[++i]);
+            settings.resignMoves = std::atoi(argv[++i]);
+        } else if (arg == "--draw" && i + 3 < argc) {
+            settings.drawScore = std::atoi(argv[++i]);
+            settings.drawMoves = std::atoi(argv[++i]);
+            settings.drawStartPly = std::atoi(argv[++i]);
+        } else if (arg == "--sprt" && i + 2 < argc) {
+            settings.sprt = true;
+            settings.elo0 = std::atof(argv[++i]);
+            settings.elo1 = std::atof(argv[++i]);
+        } else if (arg == "--alpha" && hasValue) settings.alpha = std::atof(argv[++i]);
+        else if (arg == "--beta" && hasValue) settings.beta = std::atof(argv[++i]);
+        else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // Clocked games that wait for a core lose time while not searching,
+    // and can flag without the engine being at fault
+    int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    if (settings.timeControl.enabled() && hardwareThreads > 0 && settings.concurrency > hardwareThreads) {
+        std::cerr << "Warning: --concurrency " << settings.concurrency << " exceeds the " << hardwareThreads
+                  << " hardware threads; using " << hardwareThreads << " for clocked games\n";
+        settings.concurrency = hardwareThreads;
+    }
+
+    if (!openingsFile.empty() && !loadOpenings(openingsFile, settings.openings)) {
+        std::cerr << "Cannot read " << openingsFile << "\n";
+        return 1;
+    }
+
+    Tablebase tablebase;
+    if (!tablebaseDir.empty()) {
+        if (!tablebase.open(tablebaseDir)) {
+            std::cerr << "No tablebases found in " << tablebaseDir << "\n";
+            return 1;
+        }
+        settings.tablebase = &tablebase;
+    }
+
+    std::ofstream pgn;
+    if (!pgnFile.empty()) {
+        pgn.open(pgnFile);
+        if (!pgn.is_open()) {
+            std::cerr << "Cannot write " << pgnFile << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << settings.engines[0].name << " vs " << settings.engines[1].name << ", "
+              << settings.games << " games, " << settings.concurrency << " concurrent\n";
+
+    auto start = std::chrono::steady_clock::now();
+    MatchRunner runner(settings);
+    MatchStats stats = runner.run(pgn.is_open() ? &pgn : nullptr,
+                                  [&settings](const MatchStats& current) { printStats(current, settings); });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\nFinal: ";
+    printStats(stats, settings);
+    if (settings.sprt) {
+        double lower, upper;
+        MatchRunner::sprtBounds(settings.alpha, settings.beta, lower, upper);
+        double llr = stats.llr(settings.elo0, settings.elo1);
+        std::cout << "SPRT: " << (llr >= upper ? "H1 accepted" : llr <= lower ? "H0 accepted" : "inconclusive")
+                  << "\n";
+    }
+    if (settings.timeControl.enabled()) {
+        std::cout << "Time forfeits: " << stats.timeForfeits << "\n";
+    }
+    std::cout << "Time: " << std::setprecision(1) << seconds << " s\n";
+
+    if (!statsFile.empty()) {
+        std::ofstream json(statsFile);
+        json << "{\n" << SearchStats::quoteJson(settings.engines[0].name) << ": " << stats.searchStats[0].toJson()
+             << ",\n" << SearchStats::quoteJson(settings.engines[1].name) << ": " << stats.searchStats[1].toJson()
+             << "}\n";
+        if (!SearchStats::enabled()) {
+            std::cout << "Note: built without CHESS_SEARCH_STATS, counters are zero\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * chess_server - analysis daemon on a Unix domain socket
+ *
+ * Usage:
+ *   chess_server [options]
+ *
+ * Options:
+ *   --socket PATH           Socket to listen on (default /tmp/chess_server.sock)
+ *   --workers N             Searcher threads (default 2)
+ *   --cache N               Cached results (default 4096, 0 disables)
+ *   --max-depth D           Deeper requests are clamped (default 20)
+ *   --max-time MS           Time cap per search (default 10000, 0 = none)
+ *   --max-clients N         Connections served at once (default 64)
+ *   --engine opts           Comma-separated engine options, e.g. hash=64,evalfile=net.nnue
+ *
+ * Each client sends one JSON request per line and gets one JSON reply
+ * per line, in order. A line over 4096 bytes gets an error reply.
+ *   {"id": 1, "fen": "<fen>", "depth": 10}
+ *   {"id": 2, "cmd": "stats"}
+ */
+
+#include "../include/AnalysisServer.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+int main() {
+    std::cerr << "chess_server needs Unix domain sockets, which this build does not support\n";
+    return 1;
+}
+
+#else
+
+static std::string socketPath = "/tmp/chess_server.sock";
+static std::atomic<int> clientCount(0);
+// Longest request line; a FEN and the other fields fit in far less
+static const size_t MAX_LINE = 4096;
+
+static void removeSocket(int) {
+    // unlink and _exit are async-signal-safe
+    unlink(socketPath.c_str());
+    _exit(0);
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) return false;
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+// Requests on one connection are answered in order; concurrency comes
+// from many connections sharing the server's workers
+static void serveClient(int fd, AnalysisServer& server) {
+    const std::string tooLong = "{\"ok\": false, \"error\": \"request too long\"}\n";
+    std::string pending;
+    bool skipping = false;      // Dropping the rest of an over-long line
+    bool connected = true;
+    char buffer[4096];
+    while (connected) {
+        ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+        if (count <= 0) break;
+        pending.append(buffer, static_cast<size_t>(count));
+
+        size_t newline;
+        while (connected && (newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (skipping) {
+                skipping = false;
+                continue;
+            }
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            connected = sendAll(fd, line.size() > MAX_LINE ? tooLong : server.handleLine(line) + "\n");
+        }
+
+        // An over-long line is answered once and dropped up to its newline,
+        // so a client that never sends one cannot grow the buffer
+        if (connected && pending.size() > MAX_LINE) {
+            if (!skipping) connected = sendAll(fd, tooLong);
+            skipping = true;
+            pending.clear();
+        }
+    }
+    close(fd);
+    clientCount--;
+}
+
+int main(int argc, char* argv[]) {
+    ServerOptions options;
+    int maxClients = 64;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) socketPath = argv[++i];
+        else if (arg == "--workers" && hasValue) options.workers = std::atoi(argv[++i]);
+        else if (arg == "--cache" && hasValue) options.cacheEntries = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--max-depth" && hasValue) options.maxDepth = std::atoi(argv[++i]);
+        else if (arg == "--max-time" && hasValue) options.maxTimeMs = std::atoi(argv[++i]);
+        else if (arg == "--max-clients" && hasValue) maxClients = std::atoi(argv[++i]);
+        else if (arg == "--engine" && hasValue) {
+            std::string item;
+            if (!options.engine.setOptions(argv[++i], item)) {
+                std::cerr << "Unknown engine option: " << item << "\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << "\n";
+        return 1;
+    }
+    socketPath.copy(address.sun_path, socketPath.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Cannot create socket\n";
+        return 1;
+    }
+    unlink(socketPath.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        std::cerr << "Cannot listen on " << socketPath << "\n";
+        return 1;
+    }
+    std::signal(SIGINT, removeSocket);
+    std::signal(SIGTERM, removeSocket);
+
+    AnalysisServer server(options);
+    std::cout << "Listening on " << socketPath << " with " << options.workers << " workers\n";
+
+    while (true) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            // Out of descriptors or memory: wait for clients to finish
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            std::cerr << "accept failed: " << std::strerror(errno) << "\n";
+            unlink(socketPath.c_str());
+            return 1;
+        }
+
+        // Each connection holds a thread, so their number is capped
+        if (clientCount >= maxClients) {
+            sendAll(client, "{\"ok\": false, \"error\": \"too many clients\"}\n");
+            close(client);
+            continue;
+        }
+        clientCount++;
+        std::thread(serveClient, client, std::ref(server)).detach();
+    }
+}
+
+#endif
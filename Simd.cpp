@@ -0,0 +1,46 @@
+#include "../include/Simd.h"
+
+#if defined(CHESS_X86_64) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+SimdLevel detectLevel() {
+#if !defined(CHESS_X86_64)
+    return SIMD_SCALAR;
+#else
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = osSavesYmm && (info[1] & (1 << 5)) != 0;
+    }
+#else
+    bool sse41 = __builtin_cpu_supports("sse4.1");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return avx2 ? SIMD_AVX2 : sse41 ? SIMD_SSE41 : SIMD_SCALAR;
+#endif
+}
+
+} // namespace
+
+SimdLevel supportedSimdLevel() {
+    static const SimdLevel level = detectLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE41: return "sse4.1";
+        default: return "scalar";
+    }
+}
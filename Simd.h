@@ -0,0 +1,27 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Instruction sets the vector kernels are written for. Kernels are compiled
+// for each level and chosen at run time, so one binary runs everywhere.
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE41, SIMD_AVX2 };
+
+// The widest level this CPU and OS support
+SimdLevel supportedSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHESS_X86_64
+#include <immintrin.h>
+#endif
+
+// MSVC compiles intrinsics for any instruction set; GCC and Clang need the
+// target on each function that uses them
+#if defined(__GNUC__)
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE41
+#define TARGET_AVX2
+#endif
+
+#endif // SIMD_H
@@ -0,0 +1,840 @@
+#include "../include/Tablebase.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// Per-position values shared by the DTM file and the generator:
+//   0          draw
+//   1..127     side to move mates in n plies
+//   128..253   side to move is mated in (n - 128) plies
+const uint8_t DRAW_VALUE = 0;
+const uint8_t UNRESOLVED = 254;
+const uint8_t ILLEGAL = 255;
+const int MAX_WIN_PLIES = 127;
+const int MAX_LOSS_PLIES = 125;
+const int MAX_PLY = 256;
+
+// WDL file codes, 2 bits each
+const uint8_t WDL_DRAW = 0;
+const uint8_t WDL_WIN = 1;
+const uint8_t WDL_LOSS = 2;
+const uint8_t WDL_ILLEGAL = 3;
+
+const size_t HEADER_SIZE = 16;
+
+bool isWin(uint8_t value) { return value >= 1 && value <= MAX_WIN_PLIES; }
+bool isLoss(uint8_t value) { return value >= 128 && value <= 128 + MAX_LOSS_PLIES; }
+int valuePlies(uint8_t value) { return isLoss(value) ? value - 128 : value; }
+uint8_t winValue(int plies) { return static_cast<uint8_t>(plies); }
+uint8_t lossValue(int plies) { return static_cast<uint8_t>(128 + plies); }
+
+const char PIECE_ORDER[] = "KQRBNP";
+
+int letterRank(char letter) {
+    for (int i = 0; i < 6; i++) {
+        if (PIECE_ORDER[i] == letter) return i;
+    }
+    return -1;
+}
+
+int letterValue(char letter) {
+    switch (letter) {
+        case 'Q': return 9;
+        case 'R': return 5;
+        case 'B': return 3;
+        case 'N': return 3;
+        case 'P': return 1;
+        default: return 0;
+    }
+}
+
+Piece letterToPiece(char letter, Color color) {
+    static const Piece white[] = {W_KING, W_QUEEN, W_ROOK, W_BISHOP, W_KNIGHT, W_PAWN};
+    Piece piece = white[letterRank(letter)];
+    return (color == WHITE) ? piece : (Piece)(piece + 6);
+}
+
+char pieceLetter(Piece piece) {
+    static const char letters[] = " PNBRQKPNBRQK";
+    return letters[piece];
+}
+
+Color pieceColor(Piece piece) {
+    return (piece >= B_PAWN) ? BLACK : WHITE;
+}
+
+std::string sortSide(std::string side) {
+    std::sort(side.begin(), side.end(), [](char a, char b) {
+        return letterRank(a) < letterRank(b);
+    });
+    return side;
+}
+
+// True if side a should be white in the canonical table name
+bool isStronger(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return a.size() > b.size();
+    int valueA = 0, valueB = 0;
+    for (char c : a) valueA += letterValue(c);
+    for (char c : b) valueB += letterValue(c);
+    if (valueA != valueB) return valueA > valueB;
+    // Same size and value: order by piece letters so the choice is stable
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) return letterRank(a[i]) < letterRank(b[i]);
+    }
+    return true;
+}
+
+bool splitMaterial(const std::string& material, std::string& white, std::string& black) {
+    size_t separator = material.find('v');
+    if (separator == std::string::npos) return false;
+    white = sortSide(material.substr(0, separator));
+    black = sortSide(material.substr(separator + 1));
+    if (white.empty() || black.empty()) return false;
+    if (white.size() + black.size() > Tablebase::MAX_PIECES) return false;
+    for (const std::string* side : {&white, &black}) {
+        if ((*side)[0] != 'K') return false;
+        for (size_t i = 1; i < side->size(); i++) {
+            if (letterRank((*side)[i]) <= 0) return false;
+        }
+    }
+    return true;
+}
+
+// A set of pieces on squares; square -1 marks a captured piece
+struct Placement {
+    int count;
+    Piece piece[Tablebase::MAX_PIECES];
+    int square[Tablebase::MAX_PIECES];
+    Color sideToMove;
+};
+
+// Finds the canonical table and index for an arbitrary placement.
+// Pieces are reordered and, if black is the stronger side, colors are
+// swapped and the board mirrored so the stronger side is always white.
+void canonicalize(const Placement& input, std::string& name, uint64_t& index) {
+    struct Entry { Piece piece; int square; };
+    std::vector<Entry> white, black;
+    for (int i = 0; i < input.count; i++) {
+        if (input.square[i] < 0) continue;
+        Entry entry = {input.piece[i], input.square[i]};
+        (pieceColor(input.piece[i]) == WHITE ? white : black).push_back(entry);
+    }
+
+    auto byOrder = [](const Entry& a, const Entry& b) {
+        return letterRank(pieceLetter(a.piece)) < letterRank(pieceLetter(b.piece));
+    };
+    std::stable_sort(white.begin(), white.end(), byOrder);
+    std::stable_sort(black.begin(), black.end(), byOrder);
+
+    std::string whiteName, blackName;
+    for (const Entry& entry : white) whiteName += pieceLetter(entry.piece);
+    for (const Entry& entry : black) blackName += pieceLetter(entry.piece);
+
+    Color sideToMove = input.sideToMove;
+    if (!isStronger(whiteName, blackName)) {
+        std::swap(white, black);
+        std::swap(whiteName, blackName);
+        for (Entry& entry : white) entry.square ^= 56;
+        for (Entry& entry : black) entry.square ^= 56;
+        sideToMove = (Color)(1 - sideToMove);
+    }
+
+    name = whiteName + "v" + blackName;
+    index = sideToMove;
+    for (const Entry& entry : white) index = index * 64 + entry.square;
+    for (const Entry& entry : black) index = index * 64 + entry.square;
+}
+
+// Geometry on square indices (rank * 8 + file)
+const int KNIGHT_STEPS[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+const int KING_STEPS[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+bool isSlider(char letter, int direction) {
+    // Directions 0-7 follow KING_STEPS: even are orthogonal, odd are diagonal
+    if (letter == 'Q') return true;
+    if (letter == 'R') return direction % 2 == 0;
+    if (letter == 'B') return direction % 2 == 1;
+    return false;
+}
+
+bool attacksSquare(Piece piece, int from, int target, const int* occupant) {
+    int fromRank = from / 8, fromFile = from % 8;
+    int rankDiff = target / 8 - fromRank;
+    int fileDiff = target % 8 - fromFile;
+    char letter = pieceLetter(piece);
+
+    switch (letter) {
+        case 'P': {
+            int direction = (pieceColor(piece) == WHITE) ? 1 : -1;
+            return rankDiff == direction && std::abs(fileDiff) == 1;
+        }
+        case 'N':
+            return (std::abs(rankDiff) == 1 && std::abs(fileDiff) == 2) ||
+                   (std::abs(rankDiff) == 2 && std::abs(fileDiff) == 1);
+        case 'K':
+            return std::max(std::abs(rankDiff), std::abs(fileDiff)) == 1;
+        default:
+            break;
+    }
+
+    bool straight = (rankDiff == 0) != (fileDiff == 0);
+    bool diagonal = rankDiff != 0 && std::abs(rankDiff) == std::abs(fileDiff);
+    if (!(straight && letter != 'B') && !(diagonal && letter != 'R')) return false;
+
+    int stepRank = (rankDiff > 0) - (rankDiff < 0);
+    int stepFile = (fileDiff > 0) - (fileDiff < 0);
+    int rank = fromRank + stepRank, file = fromFile + stepFile;
+    while (rank * 8 + file != target) {
+        if (occupant[rank * 8 + file] >= 0) return false;
+        rank += stepRank;
+        file += stepFile;
+    }
+    return true;
+}
+
+// Builds one table in memory
+class TableBuilder {
+private:
+    std::string name;
+    int pieceCount;
+    Piece pieces[Tablebase::MAX_PIECES];
+    uint64_t positionCount;
+    const std::map<std::string, std::vector<uint8_t>>& subtables;
+
+    std::unique_ptr<std::atomic<uint8_t>[]> values;
+    std::unique_ptr<std::atomic<uint8_t>[]> moveCounts;
+
+    struct Position {
+        int square[Tablebase::MAX_PIECES];
+        int occupant[64];
+        Color sideToMove;
+    };
+
+    struct MoveScan {
+        int inTableMoves;
+        int bestWinExit;     // Plies, or -1
+        int longestLossExit; // Plies, or -1
+        bool hasDrawExit;
+        bool hasLegalMove;
+    };
+
+    typedef std::vector<std::vector<uint32_t>> Buckets;
+
+    void decode(uint64_t index, Position& position) const;
+    uint64_t encode(const int* square, Color sideToMove) const;
+    bool isLegal(const Position& position) const;
+    bool isAttacked(int target, Color attacker, const int* square, const int* occupant) const;
+    int kingOf(Color color) const;
+    uint8_t probeExit(const Placement& placement) const;
+    void scanMoves(const Position& position, MoveScan& scan) const;
+    void visitPredecessors(const Position& position, std::vector<uint64_t>& predecessors) const;
+
+public:
+    TableBuilder(const std::string& material,
+                 const std::map<std::string, std::vector<uint8_t>>& subtables);
+
+    void build(ThreadPool& pool);
+    void exportValues(std::vector<uint8_t>& out) const;
+};
+
+TableBuilder::TableBuilder(const std::string& material,
+                           const std::map<std::string, std::vector<uint8_t>>& subtables)
+    : name(material), pieceCount(0), subtables(subtables) {
+    std::string white, black;
+    splitMaterial(material, white, black);
+    for (char letter : white) pieces[pieceCount++] = letterToPiece(letter, WHITE);
+    for (char letter : black) pieces[pieceCount++] = letterToPiece(letter, BLACK);
+
+    positionCount = 2ULL << (6 * pieceCount);
+    values.reset(new std::atomic<uint8_t>[positionCount]);
+    moveCounts.reset(new std::atomic<uint8_t>[positionCount]);
+}
+
+int TableBuilder::kingOf(Color color) const {
+    for (int i = 0; i < pieceCount; i++) {
+        if (pieces[i] == (color == WHITE ? W_KING : B_KING)) return i;
+    }
+    return -1;
+}
+
+void TableBuilder::decode(uint64_t index, Position& position) const {
+    for (int sq = 0; sq < 64; sq++) position.occupant[sq] = -1;
+    for (int i = pieceCount - 1; i >= 0; i--) {
+        position.square[i] = static_cast<int>(index & 63);
+        index >>= 6;
+    }
+    position.sideToMove = (Color)index;
+    for (int i = 0; i < pieceCount; i++) {
+        if (position.occupant[position.square[i]] >= 0) {
+            position.occupant[position.square[i]] = -2; // Two pieces on one square
+        } else {
+            position.occupant[position.square[i]] = i;
+        }
+    }
+}
+
+uint64_t TableBuilder::encode(const int* square, Color sideToMove) const {
+    uint64_t index = sideToMove;
+    for (int i = 0; i < pieceCount; i++) {
+        index = index * 64 + square[i];
+    }
+    return index;
+}
+
+bool TableBuilder::isAttacked(int target, Color attacker, const int* square,
+                              const int* occupant) const {
+    for (int i = 0; i < pieceCount; i++) {
+        if (square[i] < 0 || pieceColor(pieces[i]) != attacker) continue;
+        if (attacksSquare(pieces[i], square[i], target, occupant)) return true;
+    }
+    return false;
+}
+
+bool TableBuilder::isLegal(const Position& position) const {
+    for (int i = 0; i < pieceCount; i++) {
+        int sq = position.square[i];
+        if (position.occupant[sq] == -2) return false;
+        if (pieceLetter(pieces[i]) == 'P' && (sq < 8 || sq >= 56)) return false;
+    }
+    // The side that just moved cannot be in check
+    Color waiting = (Color)(1 - position.sideToMove);
+    return !isAttacked(position.square[kingOf(waiting)], position.sideToMove,
+                       position.square, position.occupant);
+}
+
+uint8_t TableBuilder::probeExit(const Placement& placement) const {
+    int remaining = 0;
+    for (int i = 0; i < placement.count; i++) {
+        if (placement.square[i] >= 0) remaining++;
+    }
+    if (remaining == 2) return DRAW_VALUE; // Bare kings
+
+    std::string subName;
+    uint64_t index;
+    canonicalize(placement, subName, index);
+    auto it = subtables.find(subName);
+    if (it == subtables.end()) return UNRESOLVED;
+    return it->second[index];
+}
+
+void TableBuilder::scanMoves(const Position& position, MoveScan& scan) const {
+    scan.inTableMoves = 0;
+    scan.bestWinExit = -1;
+    scan.longestLossExit = -1;
+    scan.hasDrawExit = false;
+    scan.hasLegalMove = false;
+
+    Color us = position.sideToMove;
+    int ourKing = kingOf(us);
+
+    for (int i = 0; i < pieceCount; i++) {
+        if (pieceColor(pieces[i]) != us) continue;
+
+        int from = position.square[i];
+        int fromRank = from / 8, fromFile = from % 8;
+        char letter = pieceLetter(pieces[i]);
+
+        int targets[32];
+        int targetCount = 0;
+        if (letter == 'P') {
+            int direction = (us == WHITE) ? 1 : -1;
+            int ahead = from + 8 * direction;
+            if (position.occupant[ahead] == -1) {
+                targets[targetCount++] = ahead;
+                int startRank = (us == WHITE) ? 1 : 6;
+                if (fromRank == startRank && position.occupant[ahead + 8 * direction] == -1) {
+                    targets[targetCount++] = ahead + 8 * direction;
+                }
+            }
+            for (int side = -1; side <= 1; side += 2) {
+                int file = fromFile + side;
+                if (file < 0 || file > 7) continue;
+                int target = ahead + side;
+                int victim = position.occupant[target];
+                if (victim >= 0 && pieceColor(pieces[victim]) != us) {
+                    targets[targetCount++] = target;
+                }
+            }
+        } else if (letter == 'N' || letter == 'K') {
+            const int (*steps)[2] = (letter == 'N') ? KNIGHT_STEPS : KING_STEPS;
+            for (int s = 0; s < 8; s++) {
+                int rank = fromRank + steps[s][0], file = fromFile + steps[s][1];
+                if (rank >= 0 && rank < 8 && file >= 0 && file < 8) {
+                    targets[targetCount++] = rank * 8 + file;
+                }
+            }
+        } else {
+            for (int d = 0; d < 8; d++) {
+                if (!isSlider(letter, d)) continue;
+                int rank = fromRank + KING_STEPS[d][0], file = fromFile + KING_STEPS[d][1];
+                while (rank >= 0 && rank < 8 && file >= 0 && file < 8) {
+                    targets[targetCount++] = rank * 8 + file;
+                    if (position.occupant[rank * 8 + file] >= 0) break;
+                    rank += KING_STEPS[d][0];
+                    file += KING_STEPS[d][1];
+                }
+            }
+        }
+
+        for (int t = 0; t < targetCount; t++) {
+            int to = targets[t];
+            int victim = position.occupant[to];
+            if (victim >= 0 && pieceColor(pieces[victim]) == us) continue;
+
+            int square[Tablebase::MAX_PIECES];
+            int occupant[64];
+            std::copy(position.square, position.square + pieceCount, square);
+            std::copy(position.occupant, position.occupant + 64, occupant);
+            square[i] = to;
+            occupant[from] = -1;
+            occupant[to] = i;
+            if (victim >= 0) square[victim] = -1;
+
+            if (isAttacked(square[ourKing], (Color)(1 - us), square, occupant)) continue;
+            scan.hasLegalMove = true;
+
+            bool promotion = letter == 'P' && (to < 8 || to >= 56);
+            if (victim < 0 && !promotion) {
+                scan.inTableMoves++;
+                continue;
+            }
+
+            // Captures and promotions convert into another table
+            static const char promotionLetters[] = "QRBN";
+            int variants = promotion ? 4 : 1;
+            for (int v = 0; v < variants; v++) {
+                Placement child;
+                child.count = pieceCount;
+                child.sideToMove = (Color)(1 - us);
+                for (int k = 0; k < pieceCount; k++) {
+                    child.piece[k] = pieces[k];
+                    child.square[k] = square[k];
+                }
+                if (promotion) child.piece[i] = letterToPiece(promotionLetters[v], us);
+
+                uint8_t value = probeExit(child);
+                if (isLoss(value)) {
+                    int plies = valuePlies(value) + 1;
+                    if (scan.bestWinExit < 0 || plies < scan.bestWinExit) scan.bestWinExit = plies;
+                } else if (isWin(value)) {
+                    scan.longestLossExit = std::max(scan.longestLossExit, valuePlies(value) + 1);
+                } else {
+                    scan.hasDrawExit = true;
+                }
+            }
+        }
+    }
+}
+
+void TableBuilder::visitPredecessors(const Position& position,
+                                     std::vector<uint64_t>& predecessors) const {
+    predecessors.clear();
+    Color mover = (Color)(1 - position.sideToMove);
+    int waitingKing = kingOf(position.sideToMove);
+
+    for (int i = 0; i < pieceCount; i++) {
+        if (pieceColor(pieces[i]) != mover) continue;
+
+        int to = position.square[i];
+        int toRank = to / 8, toFile = to % 8;
+        char letter = pieceLetter(pieces[i]);
+
+        int origins[32];
+        int originCount = 0;
+        if (letter == 'P') {
+            int direction = (mover == WHITE) ? 1 : -1;
+            int behind = to - 8 * direction;
+            int behindRank = behind / 8;
+            if (behindRank >= 1 && behindRank <= 6 && position.occupant[behind] == -1) {
+                origins[originCount++] = behind;
+                int startRank = (mover == WHITE) ? 1 : 6;
+                int twoBehind = behind - 8 * direction;
+                if (twoBehind / 8 == startRank && position.occupant[twoBehind] == -1) {
+                    origins[originCount++] = twoBehind;
+                }
+            }
+        } else if (letter == 'N' || letter == 'K') {
+            const int (*steps)[2] = (letter == 'N') ? KNIGHT_STEPS : KING_STEPS;
+            for (int s = 0; s < 8; s++) {
+                int rank = toRank + steps[s][0], file = toFile + steps[s][1];
+                if (rank >= 0 && rank < 8 && file >= 0 && file < 8 &&
+                    position.occupant[rank * 8 + file] == -1) {
+                    origins[originCount++] = rank * 8 + file;
+                }
+            }
+        } else {
+            for (int d = 0; d < 8; d++) {
+                if (!isSlider(letter, d)) continue;
+                int rank = toRank + KING_STEPS[d][0], file = toFile + KING_STEPS[d][1];
+                while (rank >= 0 && rank < 8 && file >= 0 && file < 8 &&
+                       position.occupant[rank * 8 + file] == -1) {
+                    origins[originCount++] = rank * 8 + file;
+                    rank += KING_STEPS[d][0];
+                    file += KING_STEPS[d][1];
+                }
+            }
+        }
+
+        for (int o = 0; o < originCount; o++) {
+            int square[Tablebase::MAX_PIECES];
+            int occupant[64];
+            std::copy(position.square, position.square + pieceCount, square);
+            std::copy(position.occupant, position.occupant + 64, occupant);
+            square[i] = origins[o];
+            occupant[to] = -1;
+            occupant[origins[o]] = i;
+
+            // Before the move the waiting side could not have been in check
+            if (isAttacked(square[waitingKing], mover, square, occupant)) continue;
+            predecessors.push_back(encode(square, mover));
+        }
+    }
+}
+
+void TableBuilder::build(ThreadPool& pool) {
+    int threads = pool.size();
+    std::vector<Buckets> winSeeds(threads, Buckets(MAX_PLY));
+    std::vector<Buckets> lossSeeds(threads, Buckets(MAX_PLY));
+
+    // Forward pass: classify every index and seed results reachable by
+    // captures, promotions and mates
+    pool.parallelFor(positionCount, [&](size_t begin, size_t end, int chunk) {
+        Position position;
+        MoveScan scan;
+        for (size_t index = begin; index < end; index++) {
+            decode(index, position);
+            moveCounts[index].store(0, std::memory_order_relaxed);
+            if (!isLegal(position)) {
+                values[index].store(ILLEGAL, std::memory_order_relaxed);
+                continue;
+            }
+
+            scanMoves(position, scan);
+            uint8_t value = UNRESOLVED;
+            if (!scan.hasLegalMove) {
+                bool inCheck = isAttacked(position.square[kingOf(position.sideToMove)],
+                                          (Color)(1 - position.sideToMove),
+                                          position.square, position.occupant);
+                if (inCheck) {
+                    lossSeeds[chunk][0].push_back(static_cast<uint32_t>(index));
+                } else {
+                    value = DRAW_VALUE;
+                }
+            } else {
+                if (scan.bestWinExit >= 0) {
+                    winSeeds[chunk][scan.bestWinExit].push_back(static_cast<uint32_t>(index));
+                } else if (scan.inTableMoves == 0) {
+                    if (scan.hasDrawExit) {
+                        value = DRAW_VALUE;
+                    } else {
+                        lossSeeds[chunk][scan.longestLossExit].push_back(static_cast<uint32_t>(index));
+                    }
+                }
+            }
+            values[index].store(value, std::memory_order_relaxed);
+            moveCounts[index].store(static_cast<uint8_t>(scan.inTableMoves), std::memory_order_relaxed);
+        }
+    });
+
+    // Retrograde pass, one ply at a time
+    for (int ply = 0; ply < MAX_PLY - 1; ply++) {
+        std::vector<uint32_t> frontier;
+        bool pending = false;
+        for (int t = 0; t < threads; t++) {
+            for (uint32_t index : winSeeds[t][ply]) {
+                uint8_t expected = UNRESOLVED;
+                if (ply <= MAX_WIN_PLIES && values[index].compare_exchange_strong(expected, winValue(ply))) {
+                    frontier.push_back(index);
+                }
+            }
+            for (uint32_t index : lossSeeds[t][ply]) {
+                uint8_t expected = UNRESOLVED;
+                if (ply <= MAX_LOSS_PLIES && values[index].compare_exchange_strong(expected, lossValue(ply))) {
+                    frontier.push_back(index);
+                }
+            }
+            winSeeds[t][ply].clear();
+            lossSeeds[t][ply].clear();
+            for (int later = ply + 1; later < MAX_PLY && !pending; later++) {
+                pending = !winSeeds[t][later].empty() || !lossSeeds[t][later].empty();
+            }
+        }
+        if (frontier.empty()) {
+            if (!pending) break;
+            continue;
+        }
+
+        pool.parallelFor(frontier.size(), [&](size_t begin, size_t end, int chunk) {
+            Position position, predecessor;
+            MoveScan scan;
+            std::vector<uint64_t> predecessors;
+            for (size_t f = begin; f < end; f++) {
+                uint32_t index = frontier[f];
+                bool lost = isLoss(values[index].load(std::memory_order_relaxed));
+                decode(index, position);
+                visitPredecessors(position, predecessors);
+
+                for (uint64_t previous : predecessors) {
+                    if (values[previous].load(std::memory_order_relaxed) != UNRESOLVED) continue;
+                    if (lost) {
+                        // Moving into a lost position wins
+                        winSeeds[chunk][ply + 1].push_back(static_cast<uint32_t>(previous));
+                    } else if (moveCounts[previous].fetch_sub(1) == 1) {
+                        // Every in-table move now loses; check the exits
+                        decode(previous, predecessor);
+                        scanMoves(predecessor, scan);
+                        if (scan.bestWinExit < 0 && !scan.hasDrawExit) {
+                            int plies = std::max(ply + 1, scan.longestLossExit);
+                            lossSeeds[chunk][plies].push_back(static_cast<uint32_t>(previous));
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // Whatever could not be resolved is a draw
+    for (uint64_t index = 0; index < positionCount; index++) {
+        if (values[index].load(std::memory_order_relaxed) == UNRESOLVED) {
+            values[index].store(DRAW_VALUE, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TableBuilder::exportValues(std::vector<uint8_t>& out) const {
+    out.resize(positionCount);
+    for (uint64_t index = 0; index < positionCount; index++) {
+        out[index] = values[index].load(std::memory_order_relaxed);
+    }
+}
+
+uint8_t toWdl(uint8_t value) {
+    if (value == ILLEGAL) return WDL_ILLEGAL;
+    if (isWin(value)) return WDL_WIN;
+    if (isLoss(value)) return WDL_LOSS;
+    return WDL_DRAW;
+}
+
+void writeHeader(std::ofstream& file, const char* magic, int pieceCount) {
+    char header[HEADER_SIZE] = {};
+    std::copy(magic, magic + 4, header);
+    header[4] = static_cast<char>(pieceCount);
+    file.write(header, HEADER_SIZE);
+}
+
+// The header must match and the size must be exactly what the material
+// indexes, so a truncated or mismatched file can never be read past its end
+bool isValidTable(const MappedFile& file, const std::string& material, bool dtm) {
+    if (TablebaseGenerator::canonicalMaterial(material) != material) return false;
+    int pieceCount = static_cast<int>(material.size()) - 1;
+    uint64_t positions = 2ULL << (6 * pieceCount);
+    uint64_t expected = HEADER_SIZE + (dtm ? positions : (positions + 3) / 4);
+    const char* magic = dtm ? "CTBM" : "CTBW";
+    return file.size() == expected && std::equal(magic, magic + 4, file.data()) &&
+           file.data()[4] == pieceCount;
+}
+
+} // namespace
+
+bool Tablebase::open(const std::string& directory) {
+    close();
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string extension = entry.path().extension().string();
+        if (extension != ".ctbm" && extension != ".ctbw") continue;
+
+        std::string material = entry.path().stem().string();
+        std::unique_ptr<Table>& table = tables[material];
+        if (!table) table.reset(new Table());
+
+        MappedFile& file = (extension == ".ctbm") ? table->dtm : table->wdl;
+        if (!file.open(entry.path().string()) || !isValidTable(file, material, extension == ".ctbm")) {
+            file.close();
+        }
+    }
+
+    // Drop tables that have neither file usable
+    for (auto it = tables.begin(); it != tables.end();) {
+        if (!it->second->dtm.isOpen() && !it->second->wdl.isOpen()) it = tables.erase(it);
+        else ++it;
+    }
+    return !error && !tables.empty();
+}
+
+void Tablebase::close() {
+    tables.clear();
+}
+
+bool Tablebase::lookup(const Board& board, const Table*& table, uint64_t& index) const {
+    const GameState& state = board.getState();
+    if (state.enPassantSquare != -1) return false;
+    if (state.canCastleKingSide[WHITE] || state.canCastleQueenSide[WHITE] ||
+        state.canCastleKingSide[BLACK] || state.canCastleQueenSide[BLACK]) {
+        return false;
+    }
+
+    Placement placement;
+    placement.count = 0;
+    placement.sideToMove = state.currentPlayer;
+    for (int sq = 0; sq < 64; sq++) {
+        if (state.board[sq] == EMPTY) continue;
+        if (placement.count == MAX_PIECES) return false;
+        placement.piece[placement.count] = state.board[sq];
+        placement.square[placement.count] = sq;
+        placement.count++;
+    }
+
+    if (placement.count == 2) {
+        table = nullptr; // Bare kings, always drawn
+        return true;
+    }
+
+    std::string name;
+    canonicalize(placement, name, index);
+    auto it = tables.find(name);
+    if (it == tables.end()) return false;
+    table = it->second.get();
+    return true;
+}
+
+bool Tablebase::probeWdl(const Board& board, int& wdl) const {
+    const Table* table;
+    uint64_t index;
+    if (!lookup(board, table, index)) return false;
+
+    uint8_t code = WDL_DRAW;
+    if (table != nullptr) {
+        if (table->wdl.isOpen()) {
+            code = (table->wdl.data()[HEADER_SIZE + index / 4] >> (2 * (index % 4))) & 3;
+        } else {
+            code = toWdl(table->dtm.data()[HEADER_SIZE + index]);
+        }
+    }
+
+    if (code == WDL_ILLEGAL) return false;
+    wdl = (code == WDL_WIN) ? 1 : (code == WDL_LOSS) ? -1 : 0;
+    return true;
+}
+
+bool Tablebase::probeDtm(const Board& board, int& wdl, int& plies) const {
+    const Table* table;
+    uint64_t index;
+    if (!lookup(board, table, index)) return false;
+
+    uint8_t value = DRAW_VALUE;
+    if (table != nullptr) {
+        if (!table->dtm.isOpen()) return false;
+        value = table->dtm.data()[HEADER_SIZE + index];
+    }
+
+    if (value == ILLEGAL) return false;
+    if (isWin(value)) {
+        wdl = 1;
+        plies = valuePlies(value);
+    } else if (isLoss(value)) {
+        wdl = -1;
+        plies = -valuePlies(value);
+    } else {
+        wdl = 0;
+        plies = 0;
+    }
+    return true;
+}
+
+TablebaseGenerator::TablebaseGenerator(int threadCount) : threadCount(threadCount) {}
+
+std::string TablebaseGenerator::canonicalMaterial(const std::string& material) {
+    std::string white, black;
+    if (!splitMaterial(material, white, black)) return "";
+    if (!isStronger(white, black)) std::swap(white, black);
+    return white + "v" + black;
+}
+
+bool TablebaseGenerator::generate(const std::string& material, const std::string& directory,
+                                  std::vector<TablebaseReport>& reports) {
+    std::string name = canonicalMaterial(material);
+    if (name.empty() || name == "KvK") return false;
+    return generateTable(name, directory, reports);
+}
+
+bool TablebaseGenerator::generateTable(const std::string& name, const std::string& directory,
+                                       std::vector<TablebaseReport>& reports) {
+    if (generated.count(name)) return true;
+
+    // Every capture and promotion leads into a smaller or different table
+    std::string white, black;
+    splitMaterial(name, white, black);
+    std::vector<std::string> dependencies;
+    for (int side = 0; side < 2; side++) {
+        const std::string& own = side == 0 ? white : black;
+        const std::string& other = side == 0 ? black : white;
+        for (size_t i = 1; i < own.size(); i++) {
+            std::string reduced = own.substr(0, i) + own.substr(i + 1);
+            dependencies.push_back(side == 0 ? reduced + "v" + other : other + "v" + reduced);
+            if (own[i] == 'P') {
+                for (char promotion : std::string("QRBN")) {
+                    std::string promoted = reduced + promotion;
+                    dependencies.push_back(side == 0 ? promoted + "v" + other : other + "v" + promoted);
+                }
+            }
+        }
+    }
+    for (const std::string& dependency : dependencies) {
+        std::string canonical = canonicalMaterial(dependency);
+        if (canonical != "KvK" && !generateTable(canonical, directory, reports)) return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    ThreadPool pool(threadCount);
+    TableBuilder builder(name, generated);
+    builder.build(pool);
+    std::vector<uint8_t>& values = generated[name];
+    builder.exportValues(values);
+
+    TablebaseReport report = {};
+    report.material = name;
+    report.positions = values.size();
+    for (uint8_t value : values) {
+        if (value == ILLEGAL) continue;
+        report.legalPositions++;
+        if (isWin(value)) {
+            report.wins++;
+            report.longestMate = std::max(report.longestMate, valuePlies(value));
+        } else if (isLoss(value)) {
+            report.losses++;
+        } else {
+            report.draws++;
+        }
+    }
+
+    std::string basePath = (std::filesystem::path(directory) / name).string();
+    std::ofstream dtmFile(basePath + ".ctbm", std::ios::binary);
+    std::ofstream wdlFile(basePath + ".ctbw", std::ios::binary);
+    if (!dtmFile.is_open() || !wdlFile.is_open()) return false;
+
+    int pieceCount = static_cast<int>(white.size() + black.size());
+    writeHeader(dtmFile, "CTBM", pieceCount);
+    dtmFile.write(reinterpret_cast<const char*>(values.data()), values.size());
+
+    writeHeader(wdlFile, "CTBW", pieceCount);
+    std::vector<uint8_t> packed((values.size() + 3) / 4, 0);
+    for (size_t index = 0; index < values.size(); index++) {
+        packed[index / 4] |= toWdl(values[index]) << (2 * (index % 4));
+    }
+    wdlFile.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+
+    report.dtmBytes = HEADER_SIZE + values.size();
+    report.wdlBytes = HEADER_SIZE + packed.size();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    reports.push_back(report);
+
+    return dtmFile.good() && wdlFile.good();
+}
@@ -0,0 +1,80 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Endgame tablebases for up to four pieces (kings included).
+//
+// A table is named by its material with the stronger side first, e.g.
+// "KQvK" or "KRvKB". Each table is stored twice:
+//   <material>.ctbw  2 bits per position (win/draw/loss/invalid)
+//   <material>.ctbm  1 byte per position (distance to mate in plies)
+// Positions are indexed as side * 64^n + sq0 * 64^(n-1) + ... with the
+// white king, white pieces, black king, black pieces in that order.
+// Castling and en passant are not represented. The files are uncompressed
+// and not reduced by board symmetry.
+
+struct TablebaseReport {
+    std::string material;
+    uint64_t positions;
+    uint64_t legalPositions;
+    uint64_t wins;
+    uint64_t draws;
+    uint64_t losses;
+    int longestMate;          // Plies
+    double seconds;
+    uint64_t wdlBytes;
+    uint64_t dtmBytes;
+};
+
+class Tablebase {
+private:
+    struct Table {
+        MappedFile wdl;
+        MappedFile dtm;
+    };
+    std::map<std::string, std::unique_ptr<Table>> tables;
+
+    bool lookup(const Board& board, const Table*& table, uint64_t& index) const;
+
+public:
+    static const int MAX_PIECES = 4;
+
+    // Maps every table found in the directory
+    bool open(const std::string& directory);
+    void close();
+    size_t tableCount() const { return tables.size(); }
+
+    // wdl: +1 side to move wins, 0 draw, -1 side to move loses
+    bool probeWdl(const Board& board, int& wdl) const;
+    // plies: >0 mate in n plies, <0 mated in n plies, 0 draw (or mated now if wdl < 0)
+    bool probeDtm(const Board& board, int& wdl, int& plies) const;
+};
+
+// Retrograde generator. Tables that a requested table converts into by
+// capture or promotion are generated first.
+class TablebaseGenerator {
+private:
+    int threadCount;
+    std::map<std::string, std::vector<uint8_t>> generated;
+
+    bool generateTable(const std::string& material, const std::string& directory,
+                       std::vector<TablebaseReport>& reports);
+
+public:
+    explicit TablebaseGenerator(int threadCount = 0);
+
+    bool generate(const std::string& material, const std::string& directory,
+                  std::vector<TablebaseReport>& reports);
+
+    // Canonical name for a material string, or "" if it is not supported
+    static std::string canonicalMaterial(const std::string& material);
+};
+
+#endif // TABLEBASE_H
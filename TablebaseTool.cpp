@@ -0,0 +1,89 @@
+/**
+ * chess_tbgen - generate endgame tablebases
+ *
+ * Usage:
+ *   chess_tbgen <directory> [--threads N] <material>...
+ *
+ * Material is written like KQvK or KRvKB. "all3" and "all4" expand to
+ * every three- or four-piece table.
+ */
+
+#include "../include/Tablebase.h"
+#include "../include/ThreadPool.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+static void addAllTables(int pieceCount, std::vector<std::string>& materials) {
+    const std::string pieces = "QRBNP";
+    std::set<std::string> names;
+    for (char a : pieces) {
+        if (pieceCount == 3) {
+            names.insert(TablebaseGenerator::canonicalMaterial(std::string("K") + a + "vK"));
+            continue;
+        }
+        for (char b : pieces) {
+            names.insert(TablebaseGenerator::canonicalMaterial(std::string("K") + a + b + "vK"));
+            names.insert(TablebaseGenerator::canonicalMaterial(std::string("K") + a + "vK" + b));
+        }
+    }
+    materials.insert(materials.end(), names.begin(), names.end());
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "Usage: chess_tbgen <directory> [--threads N] <material>...\n";
+        return 1;
+    }
+
+    std::string directory = argv[1];
+    int threads = ThreadPool::hardwareThreads();
+    std::vector<std::string> materials;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "all3") {
+            addAllTables(3, materials);
+        } else if (arg == "all4") {
+            addAllTables(4, materials);
+        } else {
+            materials.push_back(arg);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TablebaseGenerator generator(threads);
+    std::vector<TablebaseReport> reports;
+    for (const std::string& material : materials) {
+        if (!generator.generate(material, directory, reports)) {
+            std::cerr << "Failed to generate " << material << "\n";
+            return 1;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t totalBytes = 0;
+    std::cout << std::left << std::setw(8) << "Table" << std::right
+              << std::setw(12) << "Legal" << std::setw(11) << "Wins"
+              << std::setw(11) << "Draws" << std::setw(11) << "Losses"
+              << std::setw(8) << "Max" << std::setw(12) << "WDL bytes"
+              << std::setw(12) << "DTM bytes" << std::setw(10) << "Seconds" << "\n";
+    for (const TablebaseReport& report : reports) {
+        std::cout << std::left << std::setw(8) << report.material << std::right
+                  << std::setw(12) << report.legalPositions << std::setw(11) << report.wins
+                  << std::setw(11) << report.draws << std::setw(11) << report.losses
+                  << std::setw(8) << report.longestMate << std::setw(12) << report.wdlBytes
+                  << std::setw(12) << report.dtmBytes << std::setw(10) << std::fixed
+                  << std::setprecision(2) << report.seconds << "\n";
+        totalBytes += report.wdlBytes + report.dtmBytes;
+    }
+    std::cout << "\nThreads: " << threads << "\n";
+    std::cout << "Total size: " << totalBytes << " bytes\n";
+    std::cout << "Wall time: " << std::setprecision(2) << seconds << " s\n";
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "../include/ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount) : activeTasks(0), stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = hardwareThreads();
+    }
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::hardwareThreads() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : static_cast<int>(count);
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeTasks--;
+            if (activeTasks == 0) {
+                allDone.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+        activeTasks++;
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return activeTasks == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t, int)>& body) {
+    int chunks = size();
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    for (int chunk = 0; chunk < chunks; chunk++) {
+        size_t begin = chunk * chunkSize;
+        size_t end = (begin + chunkSize < count) ? begin + chunkSize : count;
+        if (begin >= end) break;
+        submit([&body, begin, end, chunk] { body(begin, end, chunk); });
+    }
+    wait();
+}
@@ -0,0 +1,45 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads fed from a shared task queue
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    size_t activeTasks;
+    bool stopping;
+
+    void workerLoop();
+
+public:
+    // threadCount <= 0 uses one thread per hardware core
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    // Splits [0, count) into one contiguous chunk per thread and blocks until
+    // all chunks are done. body(begin, end, chunkIndex)
+    void parallelFor(size_t count, const std::function<void(size_t, size_t, int)>& body);
+
+    static int hardwareThreads();
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,48 @@
+#include "../include/TimeManager.h"
+#include "../include/Search.h"
+#include <algorithm>
+
+TimeManager::TimeManager()
+    : active(false), optimumMs(0), maximumMs(0), scale(1.0), stableIterations(0), lastScore(0) {}
+
+void TimeManager::init(const SearchLimits& limits, Color side) {
+    scale = 1.0;
+    stableIterations = 0;
+    lastScore = -Search::INFINITE_SCORE;
+    active = limits.timeMs[side] > 0;
+    if (!active) return;
+
+    int remaining = limits.timeMs[side];
+    int increment = limits.incrementMs[side];
+    int usable = std::max(1, remaining - MOVE_OVERHEAD_MS);
+
+    // Sudden death plans for 40 more moves; near a time control the
+    // remaining moves share what is left
+    int movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, 40) : 40;
+    optimumMs = usable / movesToGo + increment * 3 / 4;
+
+    // Never plan to use more than a fraction of the clock on one move
+    int cap = movesToGo == 1 ? usable * 9 / 10 : usable * 4 / 10;
+    maximumMs = std::max(1, std::min(optimumMs * 5, cap));
+    optimumMs = std::max(1, std::min(optimumMs, maximumMs));
+}
+
+bool TimeManager::iterationDone(int elapsedMs, bool bestMoveChanged, int score) {
+    if (!active) return false;
+
+    if (bestMoveChanged) {
+        stableIterations = 0;
+        scale = std::min(scale * 1.4, 2.5);
+    } else if (++stableIterations >= 3) {
+        scale = std::max(scale * 0.9, 0.5);
+    }
+    if (score < lastScore - 30) {
+        scale = std::min(scale * 1.3, 2.5);
+    }
+    lastScore = score;
+
+    // The next iteration usually costs a few times the last one, so only
+    // start it with a good part of the budget left
+    int target = std::min(optimum(), maximumMs);
+    return elapsedMs >= target * 55 / 100;
+}
@@ -0,0 +1,36 @@
+#ifndef TIME_MANAGER_H
+#define TIME_MANAGER_H
+
+#include "Board.h"
+
+struct SearchLimits;
+
+// Splits the remaining clock time into a budget for one move. The optimum
+// is where iterative deepening normally stops; it grows when the best move
+// keeps changing or the score drops, and shrinks when the search is stable.
+// The maximum is a hard limit the search polls for.
+class TimeManager {
+private:
+    bool active;
+    int optimumMs;
+    int maximumMs;
+    double scale;
+    int stableIterations;
+    int lastScore;
+
+public:
+    static const int MOVE_OVERHEAD_MS = 10;   // Reserved for move transmission and setup
+
+    TimeManager();
+
+    void init(const SearchLimits& limits, Color side);
+    bool isActive() const { return active; }
+    int optimum() const { return static_cast<int>(optimumMs * scale); }
+    int maximum() const { return maximumMs; }
+
+    // Called after every completed iteration. Returns true when the next
+    // iteration should not be started.
+    bool iterationDone(int elapsedMs, bool bestMoveChanged, int score);
+};
+
+#endif // TIME_MANAGER_H
@@ -0,0 +1,58 @@
+#include "../include/TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(size_t megabytes) : mask(0) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t count = 1;
+    size_t target = (megabytes == 0 ? 1 : megabytes) * 1024 * 1024 / sizeof(TTEntry);
+    while (count * 2 <= target) {
+        count *= 2;
+    }
+    entries.assign(count, TTEntry());
+    mask = count - 1;
+}
+
+void TranspositionTable::clear() {
+    entries.assign(entries.size(), TTEntry());
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const TTEntry& slot = entries[key & mask];
+    if (slot.key != key || slot.bound == BOUND_NONE) {
+        return false;
+    }
+    entry = slot;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, uint16_t move, int score, int depth, BoundType bound) {
+    TTEntry& slot = entries[key & mask];
+    if (slot.key == key && depth < slot.depth && bound != BOUND_EXACT) {
+        return; // Keep the deeper result for this position
+    }
+    if (slot.key == key && move == 0) {
+        move = slot.move; // Do not lose a known best move
+    }
+    slot.key = key;
+    slot.move = move;
+    slot.score = static_cast<int16_t>(score);
+    slot.depth = static_cast<int8_t>(depth);
+    slot.bound = bound;
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = entries.size() < 1000 ? entries.size() : 1000;
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        if (entries[i].bound != BOUND_NONE) used++;
+    }
+    return static_cast<int>(used * 1000 / sample);
+}
+
+uint16_t TranspositionTable::packMove(const Move& move) {
+    if (move.from < 0) return 0;
+    int promotion = move.promotion == EMPTY ? 0 : (move.promotion - 1) % 6;
+    return static_cast<uint16_t>(move.from | (move.to << 6) | (promotion << 12));
+}
@@ -0,0 +1,46 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "Board.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum BoundType : uint8_t {
+    BOUND_NONE = 0,
+    BOUND_UPPER = 1,   // Fail-low, score is at most this
+    BOUND_LOWER = 2,   // Fail-high, score is at least this
+    BOUND_EXACT = 3
+};
+
+struct TTEntry {
+    uint64_t key;
+    uint16_t move;     // Packed with TranspositionTable::packMove
+    int16_t score;
+    int8_t depth;
+    uint8_t bound;
+};
+
+// Single-entry buckets, power-of-two sized, replace-if-deeper-or-new
+class TranspositionTable {
+private:
+    std::vector<TTEntry> entries;
+    size_t mask;
+
+public:
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    void resize(size_t megabytes);
+    void clear();
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, uint16_t move, int score, int depth, BoundType bound);
+
+    // Occupied entries per thousand, sampled from the first thousand slots
+    int hashfull() const;
+
+    static uint16_t packMove(const Move& move);
+    static bool samePacked(uint16_t packed, const Move& move) { return packed != 0 && packed == packMove(move); }
+};
+
+#endif // TRANSPOSITION_TABLE_H
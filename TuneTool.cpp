@@ -0,0 +1,133 @@
+/**
+ * chess_tune - Texel-style tuning of the evaluation weights
+ *
+ * Usage:
+ *   chess_tune <data>... [options]
+ *
+ * Data files ending in .pgn contribute every position of each finished
+ * game, labelled with its result; other files hold "<fen> <result>" lines.
+ *
+ * Options:
+ *   --threads N             Worker threads (default: all cores)
+ *   --epochs N              Gradient steps (default 1000)
+ *   --rate R                Adam learning rate in centipawns (default 1.0)
+ *   --skip-plies N          Opening plies skipped in PGN games (default 8)
+ *   --out FILE              Write the tuned tables there instead of stdout
+ *   --scaling               Time epochs with 1, 2, 4... threads and exit
+ */
+
+#include "../include/Tuner.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Epoch throughput for growing thread counts, on copies of the tuner so
+// the weights being timed are the same for every count
+static void reportScaling(const EvalTuner& tuner, double rate) {
+    const int epochs = 20;
+    double baseline = 0.0;
+    std::cout << "Threads  Epochs/s  Speedup\n";
+    for (int threads = 1;; threads *= 2) {
+        threads = std::min(threads, ThreadPool::hardwareThreads());
+        ThreadPool pool(threads);
+        EvalTuner copy = tuner;
+        copy.runEpoch(pool, rate);   // Warm-up
+        auto start = std::chrono::steady_clock::now();
+        for (int epoch = 0; epoch < epochs; epoch++) copy.runEpoch(pool, rate);
+        double epochsPerSecond = epochs / secondsSince(start);
+        if (threads == 1) baseline = epochsPerSecond;
+        std::cout << std::setw(7) << threads << std::setw(10) << std::fixed << std::setprecision(2)
+                  << epochsPerSecond << std::setw(9) << epochsPerSecond / baseline << "x\n";
+        if (threads == ThreadPool::hardwareThreads()) break;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threads = 0;
+    int epochs = 1000;
+    int skipPlies = 8;
+    double rate = 1.0;
+    bool scaling = false;
+    std::string outFile;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--epochs" && hasValue) epochs = std::atoi(argv[++i]);
+        else if (arg == "--rate" && hasValue) rate = std::atof(argv[++i]);
+        else if (arg == "--skip-plies" && hasValue) skipPlies = std::atoi(argv[++i]);
+        else if (arg == "--out" && hasValue) outFile = argv[++i];
+        else if (arg == "--scaling") scaling = true;
+        else if (arg.substr(0, 2) == "--") {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "Usage: chess_tune <data>... [--threads N] [--epochs N] [--rate R] [--out FILE] [--scaling]\n";
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    EvalTuner tuner;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& input : inputs) {
+        std::ifstream file(input);
+        if (!file.is_open()) {
+            std::cerr << "Cannot read " << input << "\n";
+            return 1;
+        }
+        bool pgn = input.size() > 4 && input.substr(input.size() - 4) == ".pgn";
+        if (pgn) tuner.loadPgn(file, pool, skipPlies);
+        else tuner.loadEpd(file, pool);
+    }
+    std::cout << "Positions: " << tuner.size() << " (" << tuner.getDrawsSkipped() << " drawn by material skipped, "
+              << tuner.getRejected() << " rejected), loaded in " << std::fixed << std::setprecision(2)
+              << secondsSince(start) << " s\n";
+    std::cout << "Memory: " << tuner.size() * sizeof(TunePosition) / (1024 * 1024) << " MB\n";
+    if (tuner.size() == 0) return 1;
+
+    tuner.fitScale(pool);
+    std::cout << "K: " << std::setprecision(6) << tuner.getScale() << ", starting error "
+              << std::setprecision(6) << tuner.error(pool) << "\n";
+
+    if (scaling) {
+        reportScaling(tuner, rate);
+        return 0;
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        double error = tuner.runEpoch(pool, rate);
+        if (epoch % 100 == 0 || epoch == epochs) {
+            std::cout << "Epoch " << epoch << ": error " << std::setprecision(6) << error << ", "
+                      << std::setprecision(1) << epoch / secondsSince(start) << " epochs/s on "
+                      << pool.size() << " threads\n";
+        }
+    }
+    std::cout << "Final error: " << std::setprecision(6) << tuner.error(pool) << "\n";
+
+    if (outFile.empty()) {
+        std::cout << "\n" << tuner.formatWeights();
+    } else {
+        std::ofstream out(outFile);
+        out << tuner.formatWeights();
+        if (!out.good()) {
+            std::cerr << "Cannot write " << outFile << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,306 @@
+#include "../include/Tuner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+const int MAX_QUIESCENCE_PLY = 16;
+const int INFINITE_SCORE = 32000;
+
+// Parameter layout, see EvalTuner::PARAM_COUNT
+inline int valueIndex(int type) { return type - 1; }
+inline int pieceSquareIndex(int type, int square) { return 5 + (type - 1) * 64 + square; }
+
+int victimValue(const Move& move) {
+    static const int values[7] = {0, 1, 3, 3, 5, 9, 0};
+    return move.isEnPassant ? 1 : values[pieceType(move.captured)];
+}
+
+// Capture search with stand pat; fills pv with the line to the quiet
+// position the score comes from
+int quiesce(Board& board, int alpha, int beta, int ply, Move* pv, int& pvLength) {
+    pvLength = 0;
+    int standPat = Evaluator::evaluate(board);
+    if (standPat >= beta) return beta;
+    if (standPat > alpha) alpha = standPat;
+    if (ply >= MAX_QUIESCENCE_PLY) return alpha;
+
+    MoveList moves;
+    board.generateLegalMoves(moves, GEN_CAPTURES);
+    std::sort(moves.begin(), moves.end(),
+              [](const Move& a, const Move& b) { return victimValue(a) > victimValue(b); });
+
+    Move childPv[MAX_QUIESCENCE_PLY];
+    int childLength = 0;
+    for (const Move& move : moves) {
+        board.applyMove(move);
+        int score = -quiesce(board, -beta, -alpha, ply + 1, childPv, childLength);
+        board.undoMove();
+        if (score >= beta) return beta;
+        if (score > alpha) {
+            alpha = score;
+            pv[0] = move;
+            std::copy(childPv, childPv + childLength, pv + 1);
+            pvLength = childLength + 1;
+        }
+    }
+    return alpha;
+}
+
+// White's score in half points, or -1 if the text is not a result
+int parseResult(std::string token) {
+    token.erase(std::remove_if(token.begin(), token.end(),
+                               [](char c) { return c == '"' || c == ';' || c == '[' || c == ']'; }),
+                token.end());
+    if (token == "1-0") return 2;
+    if (token == "0-1") return 0;
+    if (token == "1/2-1/2") return 1;
+    if (token == "1.0" || token == "1") return 2;
+    if (token == "0.5") return 1;
+    if (token == "0.0" || token == "0") return 0;
+    return -1;
+}
+
+} // namespace
+
+EvalTuner::EvalTuner(const EvalWeights& start)
+    : drawsSkipped(0), rejected(0), scale(0.0065), params(PARAM_COUNT), firstMoment(PARAM_COUNT, 0.0),
+      secondMoment(PARAM_COUNT, 0.0), steps(0) {
+    for (int type = PAWN; type <= KING; type++) {
+        if (type != KING) params[valueIndex(type)] = start.pieceValue[type];
+        for (int square = 0; square < 64; square++) {
+            params[pieceSquareIndex(type, square)] = start.pieceSquare[type][square];
+        }
+    }
+}
+
+bool EvalTuner::addPosition(const Board& board, int result, std::vector<TunePosition>& out, size_t& draws) const {
+    Board leaf = board;
+    Move pv[MAX_QUIESCENCE_PLY];
+    int pvLength = 0;
+    quiesce(leaf, -INFINITE_SCORE, INFINITE_SCORE, 0, pv, pvLength);
+    for (int i = 0; i < pvLength; i++) leaf.applyMove(pv[i]);
+
+    // The engine scores these as draws whatever the weights say
+    if (leaf.isDraw()) {
+        draws++;
+        return true;
+    }
+
+    TunePosition position;
+    position.pieceCount = 0;
+    position.result = static_cast<uint8_t>(result);
+    for (int square = 0; square < 64; square++) {
+        Piece piece = leaf.getPiece(square);
+        if (piece == EMPTY) continue;
+        if (position.pieceCount == 32) return false;
+        position.pieces[position.pieceCount++] = static_cast<uint16_t>(square | piece << 6);
+    }
+    out.push_back(position);
+    return true;
+}
+
+void EvalTuner::append(std::vector<std::vector<TunePosition>>& chunks, const std::vector<size_t>& draws) {
+    size_t total = positions.size();
+    for (const std::vector<TunePosition>& chunk : chunks) total += chunk.size();
+    positions.reserve(total);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        positions.insert(positions.end(), chunks[i].begin(), chunks[i].end());
+        drawsSkipped += draws[i];
+    }
+}
+
+size_t EvalTuner::loadEpd(std::istream& in, ThreadPool& pool) {
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] != '#') lines.push_back(line);
+    }
+
+    size_t before = positions.size();
+    std::vector<std::vector<TunePosition>> chunks(pool.size());
+    std::vector<size_t> draws(pool.size(), 0), failures(pool.size(), 0);
+    pool.parallelFor(lines.size(), [&](size_t begin, size_t end, int chunk) {
+        Board board;
+        for (size_t i = begin; i < end; i++) {
+            std::istringstream stream(lines[i]);
+            std::string fen, token;
+            for (int field = 0; field < 4 && stream >> token; field++) fen += (field ? " " : "") + token;
+            int result = -1;
+            while (result < 0 && stream >> token) result = parseResult(token);
+            if (result < 0 || !board.loadFromFEN(fen) || !addPosition(board, result, chunks[chunk], draws[chunk])) {
+                failures[chunk]++;
+            }
+        }
+    });
+    append(chunks, draws);
+    for (size_t count : failures) rejected += count;
+    return positions.size() - before;
+}
+
+size_t EvalTuner::loadPgn(std::istream& in, ThreadPool& pool, int skipPlies) {
+    std::vector<PgnGame> games;
+    PgnReader reader(in);
+    PgnGame game;
+    while (reader.readGame(game)) {
+        if (game.result != "*") games.push_back(game);
+    }
+
+    size_t before = positions.size();
+    std::vector<std::vector<TunePosition>> chunks(pool.size());
+    std::vector<size_t> draws(pool.size(), 0), failures(pool.size(), 0);
+    pool.parallelFor(games.size(), [&](size_t begin, size_t end, int chunk) {
+        for (size_t i = begin; i < end; i++) {
+            int result = parseResult(games[i].result);
+            Board board;
+            if (games[i].tags.count("FEN") && !board.loadFromFEN(games[i].tags.at("FEN"))) {
+                failures[chunk]++;
+                continue;
+            }
+            for (size_t ply = 0; ply < games[i].moves.size(); ply++) {
+                Move move = Notation::fromSan(board, games[i].moves[ply]);
+                if (move.from == -1) {
+                    failures[chunk]++;
+                    break;
+                }
+                board.applyMove(move);
+                if (static_cast<int>(ply) + 1 >= skipPlies) addPosition(board, result, chunks[chunk], draws[chunk]);
+            }
+        }
+    });
+    append(chunks, draws);
+    for (size_t count : failures) rejected += count;
+    return positions.size() - before;
+}
+
+double EvalTuner::evaluate(const TunePosition& position) const {
+    double score = 0.0;
+    for (int i = 0; i < position.pieceCount; i++) {
+        int square = position.pieces[i] & 63;
+        Piece piece = static_cast<Piece>(position.pieces[i] >> 6);
+        int type = pieceType(piece);
+        bool white = piece <= W_KING;
+        double value = params[pieceSquareIndex(type, white ? square : square ^ 56)];
+        if (type != KING) value += params[valueIndex(type)];
+        score += white ? value : -value;
+    }
+    return score;
+}
+
+double EvalTuner::pass(ThreadPool& pool, double k, bool gradient) {
+    int chunkCount = pool.size();
+    chunkErrors.assign(chunkCount, 0.0);
+    if (gradient) {
+        chunkGradients.resize(chunkCount);
+        for (std::vector<double>& sums : chunkGradients) sums.assign(PARAM_COUNT, 0.0);
+    }
+
+    pool.parallelFor(positions.size(), [&](size_t begin, size_t end, int chunk) {
+        double error = 0.0;
+        double* sums = gradient ? chunkGradients[chunk].data() : nullptr;
+        for (size_t i = begin; i < end; i++) {
+            const TunePosition& position = positions[i];
+            double predicted = 1.0 / (1.0 + std::exp(-k * evaluate(position)));
+            double difference = position.result * 0.5 - predicted;
+            error += difference * difference;
+            if (!sums) continue;
+
+            // d(error)/d(eval); every weight enters the eval with +1 or -1
+            double slope = -2.0 * difference * predicted * (1.0 - predicted) * k;
+            for (int n = 0; n < position.pieceCount; n++) {
+                int square = position.pieces[n] & 63;
+                Piece piece = static_cast<Piece>(position.pieces[n] >> 6);
+                int type = pieceType(piece);
+                bool white = piece <= W_KING;
+                double signedSlope = white ? slope : -slope;
+                sums[pieceSquareIndex(type, white ? square : square ^ 56)] += signedSlope;
+                if (type != KING) sums[valueIndex(type)] += signedSlope;
+            }
+        }
+        chunkErrors[chunk] = error;
+    });
+
+    double error = 0.0;
+    for (double chunkError : chunkErrors) error += chunkError;
+    return positions.empty() ? 0.0 : error / positions.size();
+}
+
+double EvalTuner::fitScale(ThreadPool& pool) {
+    // The error is unimodal in K; golden-section search
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double low = 0.0005, high = 0.05;
+    double a = high - ratio * (high - low), b = low + ratio * (high - low);
+    double errorA = pass(pool, a, false), errorB = pass(pool, b, false);
+    for (int i = 0; i < 30; i++) {
+        if (errorA < errorB) {
+            high = b;
+            b = a;
+            errorB = errorA;
+            a = high - ratio * (high - low);
+            errorA = pass(pool, a, false);
+        } else {
+            low = a;
+            a = b;
+            errorA = errorB;
+            b = low + ratio * (high - low);
+            errorB = pass(pool, b, false);
+        }
+    }
+    scale = (low + high) / 2.0;
+    return scale;
+}
+
+double EvalTuner::runEpoch(ThreadPool& pool, double learningRate) {
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    double error = pass(pool, scale, true);
+    if (positions.empty()) return error;
+
+    steps++;
+    double correction1 = 1.0 - std::pow(beta1, steps);
+    double correction2 = 1.0 - std::pow(beta2, steps);
+    for (int p = 0; p < PARAM_COUNT; p++) {
+        double gradient = 0.0;
+        for (const std::vector<double>& sums : chunkGradients) gradient += sums[p];
+        gradient /= positions.size();
+
+        firstMoment[p] = beta1 * firstMoment[p] + (1.0 - beta1) * gradient;
+        secondMoment[p] = beta2 * secondMoment[p] + (1.0 - beta2) * gradient * gradient;
+        params[p] -= learningRate * (firstMoment[p] / correction1) / (std::sqrt(secondMoment[p] / correction2) + epsilon);
+    }
+    return error;
+}
+
+EvalWeights EvalTuner::getWeights() const {
+    EvalWeights weights = {};
+    for (int type = PAWN; type <= KING; type++) {
+        weights.pieceValue[type] = type == KING ? 0 : static_cast<int>(std::lround(params[valueIndex(type)]));
+        for (int square = 0; square < 64; square++) {
+            weights.pieceSquare[type][square] = static_cast<int>(std::lround(params[pieceSquareIndex(type, square)]));
+        }
+    }
+    return weights;
+}
+
+std::string EvalTuner::formatWeights() const {
+    static const char* names[7] = {nullptr, "PAWN", "KNIGHT", "BISHOP", "ROOK", "QUEEN", "KING"};
+    EvalWeights weights = getWeights();
+    std::ostringstream out;
+    for (int type = PAWN; type <= KING; type++) {
+        out << "const int " << names[type] << "_TABLE[64] = {\n";
+        for (int rank = 7; rank >= 0; rank--) {
+            out << "   ";
+            for (int file = 0; file < 8; file++) {
+                out << std::setw(4) << weights.pieceSquare[type][rank * 8 + file] << (rank || file < 7 ? "," : "");
+            }
+            out << "\n";
+        }
+        out << "};\n\n";
+    }
+    out << "static const int values[7] = {0";
+    for (int type = PAWN; type <= KING; type++) out << ", " << weights.pieceValue[type];
+    out << "};\n";
+    return out.str();
+}
@@ -0,0 +1,79 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "Board.h"
+#include "Evaluation.h"
+#include "Pgn.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// A labelled position after quiescence, reduced to what the evaluation
+// reads. 66 bytes, so millions of positions fit in memory.
+struct TunePosition {
+    uint16_t pieces[32];        // square | piece << 6
+    uint8_t pieceCount;
+    uint8_t result;             // White's score in half points: 0, 1 or 2
+};
+
+// Texel-style tuning of EvalWeights: minimises the mean squared difference
+// between game results and sigmoid(K * eval) over quiet positions with
+// Adam gradient descent. The evaluation is linear in the weights, so each
+// epoch is one pass over the positions; the pass is split across a thread
+// pool, each chunk summing its own error and gradient before one reduction.
+class EvalTuner {
+public:
+    // Piece values pawn to queen, then the piece-square tables pawn to king
+    static const int PARAM_COUNT = 5 + 6 * 64;
+
+private:
+    std::vector<TunePosition> positions;
+    size_t drawsSkipped;        // Quiet positions Board::isDraw() scores as 0
+    size_t rejected;            // Unreadable lines and illegal moves
+    double scale;               // K, in win probability per centipawn
+    std::vector<double> params;
+
+    // Adam state
+    std::vector<double> firstMoment;
+    std::vector<double> secondMoment;
+    int steps;
+
+    // Per-chunk sums, kept between epochs so a pass never allocates
+    std::vector<std::vector<double>> chunkGradients;
+    std::vector<double> chunkErrors;
+
+    bool addPosition(const Board& board, int result, std::vector<TunePosition>& out, size_t& draws) const;
+    void append(std::vector<std::vector<TunePosition>>& chunks, const std::vector<size_t>& draws);
+    double evaluate(const TunePosition& position) const;
+    double pass(ThreadPool& pool, double k, bool gradient);
+
+public:
+    explicit EvalTuner(const EvalWeights& start = EvalWeights::defaults());
+
+    // Lines of "<fen> <result>", the result as 1-0, 0-1, 1/2-1/2 or a
+    // white score such as [0.5]. Returns the number of positions added.
+    size_t loadEpd(std::istream& in, ThreadPool& pool);
+    // Every position of every finished game from skipPlies on, labelled
+    // with the game's result
+    size_t loadPgn(std::istream& in, ThreadPool& pool, int skipPlies = 8);
+
+    size_t size() const { return positions.size(); }
+    size_t getDrawsSkipped() const { return drawsSkipped; }
+    size_t getRejected() const { return rejected; }
+
+    // Picks the K that fits the current weights best; call before tuning
+    double fitScale(ThreadPool& pool);
+    double getScale() const { return scale; }
+    double error(ThreadPool& pool) { return pass(pool, scale, false); }
+
+    // One gradient step over all positions; returns the error before it
+    double runEpoch(ThreadPool& pool, double learningRate);
+
+    EvalWeights getWeights() const;     // Rounded to whole centipawns
+    // The weights as C++ tables in the layout of Evaluation.cpp
+    std::string formatWeights() const;
+};
+
+#endif // TUNER_H
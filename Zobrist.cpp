@@ -0,0 +1,53 @@
+#include "../include/Zobrist.h"
+
+namespace {
+
+const int KEY_COUNT = 781;
+const int CASTLE_OFFSET = 768;
+const int EN_PASSANT_OFFSET = 772;
+const int SIDE_OFFSET = 780;
+
+struct KeyTable {
+    uint64_t values[KEY_COUNT];
+
+    KeyTable() {
+        // SplitMix64 with a fixed seed
+        uint64_t seed = 0x9E3779B97F4A7C15ULL ^ 0x436865737347616DULL;
+        for (int i = 0; i < KEY_COUNT; i++) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            values[i] = z ^ (z >> 31);
+        }
+    }
+};
+
+// Polyglot orders pieces as black pawn, white pawn, black knight, ...
+int polyglotKind(Piece piece) {
+    if (piece >= W_PAWN && piece <= W_KING) return 2 * (piece - W_PAWN) + 1;
+    return 2 * (piece - B_PAWN);
+}
+
+} // namespace
+
+const uint64_t* Zobrist::keys() {
+    static const KeyTable table;
+    return table.values;
+}
+
+uint64_t Zobrist::pieceKey(Piece piece, int square) {
+    return keys()[64 * polyglotKind(piece) + square];
+}
+
+uint64_t Zobrist::castleKey(int index) {
+    return keys()[CASTLE_OFFSET + index];
+}
+
+uint64_t Zobrist::enPassantKey(int file) {
+    return keys()[EN_PASSANT_OFFSET + file];
+}
+
+uint64_t Zobrist::sideKey() {
+    return keys()[SIDE_OFFSET];
+}
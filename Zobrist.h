@@ -0,0 +1,23 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "Board.h"
+#include <cstdint>
+
+// Zobrist keys in the Polyglot layout: 768 piece-square keys, 4 castling
+// keys, 8 en passant file keys and one side-to-move key. The values come
+// from a fixed-seed generator, so hashes are stable across builds and
+// platforms but do not match Polyglot's; books use their own .cbk format
+// (see OpeningBook.h) and must be built with chess_book.
+class Zobrist {
+public:
+    static uint64_t pieceKey(Piece piece, int square);
+    static uint64_t castleKey(int index);   // 0=WK, 1=WQ, 2=BK, 3=BQ
+    static uint64_t enPassantKey(int file);
+    static uint64_t sideKey();              // Toggled when white is to move
+
+private:
+    static const uint64_t* keys();
+};
+
+#endif // ZOBRIST_H
@@ -1,7 +1,28 @@
+#include "../include/AnalysisServer.h"
+#include "../include/AnalysisTree.h"
+#include "../include/BatchEvaluation.h"
 #include "../include/Board.h"
 #include "../include/Game.h"
+#include "../include/OpeningBook.h"
+#include "../include/Pgn.h"
+#include "../include/Replay.h"
+#include "../include/Tablebase.h"
+#include "../include/Search.h"
+#include "../include/Match.h"
+#include "../include/MateSolver.h"
+#include "../include/PerftCluster.h"
+#include "../include/Tuner.h"
+#include "../include/Nnue.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
 #include <cassert>
+#include <filesystem>
+#include <cmath>
+#include <chrono>
+#include <thread>
 
 void testBoardInitialization() {
     Board board;
@@ -52,6 +73,800 @@ void testMoveGeneration() {
     std::cout << "✓ Move generation test passed\n";
 }
 
+void testPerft() {
+    // Published leaf counts of the standard perft positions
+    struct { const char* fen; int depth; uint64_t nodes; } positions[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3, 8902},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 2, 2039},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3, 2812},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 2, 264},
+        {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 2, 1486},
+        // In check: single, double, and the checking pawn taken en passant
+        {"r3k2r/p1pp1pb1/bn2Qnp1/2qPN3/1p2P3/2N5/PPPBBPPP/R3K2R b KQkq - 3 2", 3, 11766},
+        {"4k3/8/8/8/1b6/8/8/R3K2r w Q - 0 1", 3, 884},
+        {"8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 3", 3, 492},
+    };
+    for (const auto& position : positions) {
+        Board board;
+        bool loaded = board.loadFromFEN(position.fen);
+        assert(loaded);
+        assert(board.perft(position.depth) == position.nodes);
+
+        // Captures and quiets split the full list
+        MoveList all, captures, quiets;
+        board.generateLegalMoves(all);
+        board.generateLegalMoves(captures, GEN_CAPTURES);
+        board.generateLegalMoves(quiets, GEN_QUIETS);
+        assert(captures.size() + quiets.size() == all.size());
+    }
+
+    std::cout << "✓ Perft test passed\n";
+}
+
+void testCastling() {
+    Game game;
+    const char* moves[] = {"e2e4", "e7e5", "g1f3", "b8c6", "f1c4", "g8f6", "e1g1"};
+    for (const char* move : moves) {
+        bool made = game.makeMove(move);
+        assert(made);
+    }
+
+    // King on g1, rook moved to f1
+    assert(game.getBoard().getPiece(6) == W_KING);
+    assert(game.getBoard().getPiece(5) == W_ROOK);
+    assert(game.getBoard().getPiece(7) == EMPTY);
+
+    std::cout << "✓ Castling test passed\n";
+}
+
+void testAnalysisTree() {
+    AnalysisTree tree;
+    Game game;
+    auto play = [&](const std::string& text) {
+        Move move = game.parseMove(text);
+        bool made = game.makeMove(move);
+        assert(made);
+        return tree.addMove(move);
+    };
+
+    // 1. e4 e5 2. Nf3 and 1. Nf3 e5 2. e4 reach the same position
+    uint32_t e4 = play("e2e4");
+    bool moved = tree.goTo(e4);
+    assert(moved);
+    moved = tree.goTo(play("e7e5"));
+    assert(moved);
+    uint32_t first = play("g1f3");
+    moved = tree.goTo(AnalysisTree::ROOT);
+    assert(moved);
+    game.newGame();
+    uint32_t nf3 = play("g1f3");
+    moved = tree.goTo(nf3);
+    assert(moved);
+    moved = tree.goTo(play("e7e5"));
+    assert(moved);
+    uint32_t second = play("e2e4");
+    assert(tree.nodeCount() == 7 && tree.positionCount() == 6);
+    assert(tree.transpositions(first).size() == 2);
+    assert(tree.transpositions(nf3).size() == 1);
+
+    // Analysis of one line is seen from the other, and is not made shallower
+    int score = 0, depth = 0;
+    bool found = tree.getAnalysis(first, score, depth);
+    assert(!found);
+    tree.setAnalysis(first, 35, 12);
+    tree.setAnalysis(second, -10, 4);
+    found = tree.getAnalysis(second, score, depth);
+    assert(found && score == 35 && depth == 12);
+
+    // Navigation across branches gives the same position as replaying
+    moved = tree.goTo(first);
+    assert(moved);
+    assert(tree.getBoard().getHash() == game.getBoard().getHash());
+    moved = tree.goTo(e4);
+    assert(moved && tree.getBoard().toFEN().substr(0, 8) == "rnbqkbnr");
+    moved = tree.goToParent();
+    assert(moved && tree.current() == AnalysisTree::ROOT);
+    moved = tree.goToParent();
+    assert(!moved);
+
+    // Existing moves are found, illegal ones refused; sidelines follow the
+    // main line until promoted
+    uint32_t added = tree.addMove(Move(6, 21, W_KNIGHT));
+    assert(added == nf3);
+    assert(tree.firstChild(AnalysisTree::ROOT) == e4 && tree.nextSibling(e4) == nf3);
+    added = tree.addMove(Move(12, 36, W_PAWN));
+    assert(added == AnalysisTree::NO_NODE);
+    tree.promoteVariation(nf3);
+    assert(tree.firstChild(AnalysisTree::ROOT) == nf3 && tree.nextSibling(nf3) == e4);
+    assert(tree.nextSibling(e4) == AnalysisTree::NO_NODE);
+
+    // Castling, en passant and promotion survive packing
+    const char* fen = "r3k2r/P7/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1";
+    bool reset = tree.reset(fen);
+    assert(reset);
+    game.newGame(fen);
+    const char* line[] = {"e5d6", "e8c8", "e1g1", "h8h7", "a7a8N"};
+    for (const char* text : line) {
+        moved = tree.goTo(play(text));
+        assert(moved);
+    }
+    assert(tree.ply(tree.current()) == 5 && tree.moveText(tree.current()) == "a7a8N");
+    assert(tree.getBoard().toFEN() == game.getBoard().toFEN());
+    moved = tree.goTo(AnalysisTree::ROOT);
+    assert(moved && tree.getBoard().toFEN() == fen);
+    assert(tree.memoryUsage() >= tree.nodeCount() * 20);
+
+    std::cout << "✓ Analysis tree test passed\n";
+}
+
+void testOpeningBook() {
+    std::istringstream pgn(
+        "[Event \"A\"]\n\n1. e4 e5 2. Nf3 {main line} Nc6 (2... d6) 3. Bb5 1-0\n\n"
+        "[Event \"B\"]\n\n1. e4 c5 2. Nf3 d6 1/2-1/2\n\n"
+        "[Event \"C\"]\n\n1. d4 d5 0-1\n");
+
+    BookBuilder builder;
+    PgnReader reader(pgn);
+    PgnGame game;
+    while (reader.readGame(game)) {
+        builder.addGame(game);
+    }
+    assert(builder.getGameCount() == 3);
+
+    const char* filename = "basic_test_book.cbk";
+    bool written = builder.write(filename);
+    assert(written);
+
+    OpeningBook book;
+    bool opened = book.open(filename);
+    assert(opened);
+
+    // A Polyglot book is the same records without the header; its keys
+    // would never match, so it is refused
+    {
+        std::ofstream polyglot("basic_test_book.bin", std::ios::binary);
+        polyglot.write(std::string(32, '\x42').data(), 32);
+    }
+    OpeningBook foreign;
+    opened = foreign.open("basic_test_book.bin");
+    assert(!opened && foreign.size() == 0);
+    std::remove("basic_test_book.bin");
+
+    // 1.e4 scored a win and a draw for white, 1.d4 a loss
+    Board board;
+    std::vector<BookEntry> entries = book.probe(board.getHash());
+    assert(entries.size() == 1);
+
+    Move move;
+    bool picked = book.pickMove(board, move);
+    assert(picked);
+    assert(move.from == 12 && move.to == 28);
+
+    book.close();
+    std::remove(filename);
+
+    std::cout << "✓ Opening book test passed\n";
+}
+
+void testFen() {
+    const std::string fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    Board board;
+    bool loaded = board.loadFromFEN(fen);
+    assert(loaded);
+    assert(board.toFEN() == fen);
+    assert(board.getPiece(4) == W_KING);
+    loaded = board.loadFromFEN("not a fen");
+    assert(!loaded);
+
+    // Pawns on the back ranks and missing or extra kings are refused, and
+    // the board is left as it was
+    const char* invalid[] = {
+        "P7/8/8/8/8/8/8/K6k w - - 0 1",
+        "P6k/8/8/8/8/8/8/K7 w - - 0 1",
+        "k7/8/8/8/8/8/8/K6p b - - 0 1",
+        "8/8/8/8/8/8/8/8 w - - 0 1",
+        "k7/8/8/8/8/8/8/7k w - - 0 1",
+        "kK6/8/8/8/8/8/8/K7 w - - 0 1",
+    };
+    for (const char* text : invalid) {
+        loaded = board.loadFromFEN(text);
+        assert(!loaded);
+    }
+    assert(board.toFEN() == fen);
+
+    // The rendered board has the same layout as print() always had
+    board.initializeStartingPosition();
+    std::string text = board.render();
+    assert(text.find("\n  a b c d e f g h\n8 r n b q k b n r 8\n7 p p p p p p p p 7\n") == 0);
+    assert(text.find("1 R N B Q K B N R 1\n  a b c d e f g h\n\nTo move: White\n") != std::string::npos);
+
+    std::cout << "✓ FEN test passed\n";
+}
+
+void testPositionStatus() {
+    Board board;
+    assert(board.getStatus().terminal == NOT_TERMINAL);
+    assert(board.hasLegalMove());
+    assert(board.legalMoveCount() == 20);
+
+    // Fool's mate, then back out of it
+    board.loadFromFEN("rnbqkbnr/pppp1ppp/8/4p3/6P1/5P2/PPPPP2P/RNBQKBNR b KQkq - 0 2");
+    bool made = board.makeMove(Move(59, 31, B_QUEEN));
+    assert(made);
+    assert(board.getStatus().inCheck && board.isCheckmate());
+    assert(!board.hasLegalMove());
+    assert(board.legalMoveCount() == 0);
+    board.undoMove();
+    assert(!board.getStatus().inCheck && board.getStatus().hasLegalMove);
+
+    board.loadFromFEN("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    assert(board.isStalemate() && board.getStatus().terminal == TERMINAL_STALEMATE);
+    board.loadFromFEN("8/8/4k3/8/8/4K3/4N3/8 w - - 0 1");
+    assert(board.getStatus().terminal == TERMINAL_INSUFFICIENT_MATERIAL);
+
+    std::cout << "✓ Position status test passed\n";
+}
+
+void testReplay() {
+    ReplayGame foolsMate;
+    foolsMate.moves = {"f2f3", "e7e5", "g2g4", "d8h4"};
+    ReplayGame sanGame;
+    sanGame.moves = {"e4", "e5", "Nf3", "Nc6", "Bb5", "a6", "O-O"};
+    ReplayGame illegal;
+    illegal.moves = {"e2e4", "e7e5", "e4e5"};
+
+    ReplayOutcome outcome = GameReplayer::replay(foolsMate, MOVES_COORDINATE);
+    assert(outcome.valid && outcome.movesApplied == 4 && outcome.result == BLACK_WINS);
+    outcome = GameReplayer::replay(sanGame, MOVES_SAN);
+    assert(outcome.valid && outcome.result == GAME_ONGOING);
+    outcome = GameReplayer::replay(illegal, MOVES_COORDINATE);
+    assert(!outcome.valid && outcome.movesApplied == 2);
+
+    std::vector<ReplayGame> games = {foolsMate, illegal, foolsMate};
+    std::vector<ReplayOutcome> outcomes;
+    ReplayReport report = GameReplayer::replayAll(games, MOVES_COORDINATE, 2, &outcomes);
+    assert(report.games == 3 && report.moves == 10 && report.invalidGames == 1);
+    assert(outcomes.size() == 3 && !outcomes[1].valid);
+
+    std::cout << "✓ Replay test passed\n";
+}
+
+void testTimeManagement() {
+    TimeControl control;
+    bool parsed = TimeControl::parse("1+0.01", control);
+    assert(parsed && control.baseMs == 1000 && control.incrementMs == 10 && control.movesPerPeriod == 0);
+    parsed = TimeControl::parse("40/60", control);
+    assert(parsed && control.movesPerPeriod == 40);
+    parsed = TimeControl::parse("fast", control);
+    assert(!parsed);
+
+    // Budgets stay inside the clock, even with almost nothing left
+    SearchLimits limits;
+    limits.timeMs[WHITE] = 1000;
+    limits.incrementMs[WHITE] = 10;
+    TimeManager manager;
+    manager.init(limits, WHITE);
+    assert(manager.isActive() && manager.optimum() > 0);
+    assert(manager.optimum() <= manager.maximum() && manager.maximum() < 1000);
+    limits.timeMs[WHITE] = 5;
+    manager.init(limits, WHITE);
+    assert(manager.maximum() <= 5);
+    manager.init(limits, BLACK);
+    assert(!manager.isActive());
+
+    // Engine moves at 1+0.01 stay on the clock
+    parsed = TimeControl::parse("1+0.01", control);
+    assert(parsed);
+    Game clocked;
+    clocked.setTimeControl(control);
+    Search white, black;
+    SearchLimits engineLimits;
+    engineLimits.depth = Search::MAX_PLY;
+    for (int ply = 0; ply < 40 && clocked.getResult() == GAME_ONGOING; ply++) {
+        bool moved = clocked.makeComputerMove(ply % 2 ? black : white, engineLimits);
+        assert(moved);
+        assert(!clocked.isTimeForfeit());
+    }
+
+    // A clock that is already out of time flags on the next move
+    parsed = TimeControl::parse("0.001", control);
+    assert(parsed);
+    Game game;
+    game.setTimeControl(control);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    bool made = game.makeMove("e2e4");
+    assert(made);
+    assert(game.isTimeForfeit() && game.getResult() == BLACK_WINS);
+
+    std::cout << "✓ Time management test passed\n";
+}
+
+void testPondering() {
+    SearchLimits limits;
+    limits.depth = 3;
+    Board start;
+    Search reference;
+    SearchResult expected = reference.think(start, limits);
+    assert(expected.pv.size() >= 2);
+
+    // The expected reply turns the ponder search into the next move's search
+    Search engine;
+    Game game;
+    game.setPondering(true);
+    bool made = game.makeComputerMove(engine, limits);
+    assert(made);
+    assert(game.getMoveHistory().back().matches(expected.pv[0]));
+    assert(game.isPondering());
+    made = game.makeMove(expected.pv[1]);
+    assert(made);
+    made = game.makeComputerMove(engine, limits);
+    assert(made);
+    assert(game.getMoveHistory().size() == 3 && game.isPondering());
+
+    // Any other reply cancels it
+    std::vector<Move> replies = game.getBoard().generateLegalMoves();
+    made = game.makeMove(replies.back());
+    assert(made);
+    assert(!game.isPondering());
+    made = game.makeComputerMove(engine, limits);
+    assert(made);
+    game.newGame();
+    assert(!game.isPondering());
+
+    std::cout << "✓ Pondering test passed\n";
+}
+
+void testBatchEvaluation() {
+    // Known positions plus a deterministic random walk, more than one SIMD
+    // block and not a multiple of the lane count
+    std::vector<Board> positions(3);
+    positions[1].loadFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    positions[2].loadFromFEN("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 0 1");
+    Board walk;
+    uint32_t seed = 12345;
+    while (positions.size() < 37) {
+        std::vector<Move> moves = walk.generateLegalMoves();
+        if (moves.empty()) walk.initializeStartingPosition();
+        else walk.makeMove(moves[((seed = seed * 1103515245 + 12345) >> 16) % moves.size()]);
+        positions.push_back(walk);
+    }
+
+    PositionBatch batch(positions.size());
+    for (const Board& board : positions) {
+        bool added = batch.add(board);
+        assert(added);
+    }
+
+    BatchEvaluator evaluator;
+    for (int level = SIMD_SCALAR; level <= supportedSimdLevel(); level++) {
+        BatchFeatures features;
+        evaluator.evaluate(batch, features, static_cast<SimdLevel>(level));
+        assert(features.material.size() == positions.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            EvalFeatures expected = BatchEvaluator::reference(positions[i]);
+            EvalFeatures actual = features.at(i);
+            assert(actual.material == expected.material && actual.pieceSquare == expected.pieceSquare &&
+                   actual.mobility == expected.mobility);
+        }
+    }
+
+    // Material and piece-square features add up to the static evaluation
+    for (const Board& board : positions) {
+        EvalFeatures features = BatchEvaluator::reference(board);
+        int whiteScore = Evaluator::evaluate(board) * (board.getCurrentPlayer() == WHITE ? 1 : -1);
+        assert(features.material + features.pieceSquare == whiteScore);
+    }
+    EvalFeatures start = BatchEvaluator::reference(positions[0]);
+    assert(start.material == 0 && start.mobility == 0);
+
+    std::cout << "✓ Batch evaluation test passed\n";
+}
+
+void testNnue() {
+    const char* filename = "test_network.nnue";
+    NnueNetwork network;
+    bool loaded = network.load("missing.nnue");
+    assert(!loaded);
+    loaded = NnueNetwork::writeRandom(filename, 2024) && network.load(filename);
+    assert(loaded);
+    if (!loaded) return;
+
+    auto sameAccumulator = [](const NnueAccumulator& a, const NnueAccumulator& b) {
+        return std::memcmp(a.values, b.values, sizeof(a.values)) == 0 &&
+               a.kingSquare[WHITE] == b.kingSquare[WHITE] && a.kingSquare[BLACK] == b.kingSquare[BLACK];
+    };
+
+    // Random walks through castling, en passant and promotions: after every
+    // move and every undo the incremental accumulator equals a refresh
+    const char* fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    };
+    uint32_t seed = 777;
+    for (const char* fen : fens) {
+        Board board;
+        board.loadFromFEN(fen);
+        board.setNetwork(&network);
+        int plies = 0;
+        for (; plies < 60; plies++) {
+            std::vector<Move> moves = board.generateLegalMoves();
+            if (moves.empty()) break;
+            board.applyMove(moves[((seed = seed * 1103515245 + 12345) >> 16) % moves.size()]);
+
+            Board fresh;
+            fresh.loadFromFEN(board.toFEN());
+            fresh.setNetwork(&network);
+            assert(sameAccumulator(board.getAccumulator(), fresh.getAccumulator()));
+
+            int expected = network.evaluate(board.getAccumulator(), board.getCurrentPlayer(), SIMD_SCALAR);
+            for (int level = SIMD_SSE41; level <= supportedSimdLevel(); level++) {
+                assert(network.evaluate(board.getAccumulator(), board.getCurrentPlayer(),
+                                        static_cast<SimdLevel>(level)) == expected);
+            }
+        }
+        for (; plies > 0; plies--) board.undoMove();
+        Board start;
+        start.loadFromFEN(fen);
+        start.setNetwork(&network);
+        assert(sameAccumulator(board.getAccumulator(), start.getAccumulator()));
+    }
+
+    // En passant for both colors removes the pawn behind the target square
+    const char* enPassant[][2] = {
+        {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6"},
+        {"4k3/8/8/8/3Pp3/8/8/4K3 b - d3 0 1", "e4d3"},
+    };
+    for (const auto& test : enPassant) {
+        Game game;
+        bool loaded = game.newGame(test[0]);
+        assert(loaded);
+        Board board = game.getBoard();
+        board.setNetwork(&network);
+        Move move = game.parseMove(test[1]);
+        bool made = board.makeMove(move);
+        assert(made);
+        Board fresh;
+        fresh.loadFromFEN(board.toFEN());
+        fresh.setNetwork(&network);
+        assert(sameAccumulator(board.getAccumulator(), fresh.getAccumulator()));
+    }
+
+    // The engine searches with the network when given one
+    EngineConfig config;
+    config.setOption("evalfile", filename);
+    Search engine(config);
+    assert(engine.usesNnue());
+    SearchLimits limits;
+    limits.depth = 3;
+    Board board;
+    SearchResult result = engine.think(board, limits);
+    assert(board.isValidMove(result.bestMove));
+
+    network.close();
+    std::remove(filename);
+    std::cout << "✓ NNUE test passed\n";
+}
+
+void testAnalysisServer() {
+    ServerOptions options;
+    options.workers = 2;
+    options.engine.hashMb = 1;
+    AnalysisServer server(options);
+
+    std::string reply = server.handleLine("{\"id\": 7, \"cmd\": \"analyse\", \"depth\": 3}");
+    assert(reply.find("\"id\": 7") != std::string::npos && reply.find("\"ok\": true") != std::string::npos);
+    assert(reply.find("\"cached\": false") != std::string::npos);
+    reply = server.handleLine("{\"id\": \"again\", \"depth\": 3}");
+    assert(reply.find("\"id\": \"again\"") != std::string::npos && reply.find("\"cached\": true") != std::string::npos);
+
+    reply = server.handleLine("{\"fen\": \"not a fen\"}");
+    assert(reply.find("invalid fen") != std::string::npos);
+    reply = server.handleLine("depth 3");
+    assert(reply.find("malformed request") != std::string::npos);
+
+    // Only strings and numbers are echoed as the id
+    reply = server.handleLine("{\"id\": 1, \"x\": 2, \"depth\": 1}");
+    assert(reply.find("\"ok\": true") != std::string::npos);
+    reply = server.handleLine("{\"id\": abc\"x, \"depth\": 1}");
+    assert(reply.find("invalid id") != std::string::npos && reply.find("abc") == std::string::npos);
+    reply = server.handleLine("{\"id\": -2.5e3, \"depth\": 1}");
+    assert(reply.find("\"id\": -2.5e3") != std::string::npos);
+
+    // Impossible positions are rejected; mated and stalemated sides get no move
+    reply = server.handleLine("{\"fen\": \"8/8/8/8/8/8/8/8 w - - 0 1\", \"depth\": 2}");
+    assert(reply.find("invalid fen") != std::string::npos);
+    reply = server.handleLine("{\"fen\": \"P6k/8/8/8/8/8/8/K7 w - - 0 1\", \"depth\": 2}");
+    assert(reply.find("invalid fen") != std::string::npos);
+    reply = server.handleLine("{\"fen\": \"k7/8/8/8/8/8/8/R6K w - - 0 1\", \"depth\": 2}");
+    assert(reply.find("invalid position") != std::string::npos);
+    reply = server.handleLine("{\"fen\": \"rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3\", \"depth\": 2}");
+    assert(reply.find("\"terminal\": \"checkmate\"") != std::string::npos && reply.find("bestmove") == std::string::npos);
+    reply = server.handleLine("{\"fen\": \"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1\", \"depth\": 2}");
+    assert(reply.find("\"terminal\": \"stalemate\"") != std::string::npos);
+
+    // Identical requests at once cost a single search
+    const std::string fen = "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3";
+    std::vector<std::thread> clients;
+    std::vector<AnalysisResult> results(4);
+    for (int i = 0; i < 4; i++) {
+        clients.emplace_back([&, i] { results[i] = server.analyse(fen, 4); });
+    }
+    for (std::thread& client : clients) client.join();
+    for (const AnalysisResult& result : results) {
+        assert(result.ok && result.bestMove == results[0].bestMove && result.score == results[0].score);
+    }
+
+    ServerStats stats = server.getStats();
+    assert(stats.requests == 14 && stats.searches == 3);
+    assert(stats.cacheHits + stats.coalesced == 5 && stats.cacheEntries == 3);
+    assert(stats.p99Ms >= stats.p50Ms);
+    reply = server.handleLine("{\"cmd\": \"stats\"}");
+    assert(reply.find("\"p99Ms\"") != std::string::npos);
+
+    // The least recently used result is evicted first
+    options.cacheEntries = 1;
+    AnalysisServer small(options);
+    small.analyse(fen, 2);
+    small.analyse(fen, 3);
+    bool cached = small.analyse(fen, 3).cached;
+    assert(cached);
+    cached = small.analyse(fen, 2).cached;
+    assert(!cached);
+
+    std::cout << "✓ Analysis server test passed\n";
+}
+
+void testTuner() {
+    // Labels that reward material: the side with the extra piece wins.
+    // The first line needs quiescence (the queen hangs), the last is a
+    // bare-kings draw that the tuner must skip.
+    std::istringstream data(
+        "4k3/8/8/3q4/4P3/8/8/4K3 w - - 0 1 1-0\n"
+        "4k3/8/8/8/8/8/8/RN2K3 w - - 0 1 [1.0]\n"
+        "rn2k3/8/8/8/8/8/8/4K3 b - - 0 1 0-1\n"
+        "4k3/pppp4/8/8/8/8/PPPP4/4K3 w - - 0 1 1/2-1/2\n"
+        "3qk3/8/8/8/8/8/3P4/4K3 w - - 0 1 \"0-1\";\n"
+        "4k3/8/8/8/8/8/8/4K3 w - - 0 1 1/2-1/2\n"
+        "not a position 1-0\n");
+    ThreadPool pool(2);
+    EvalTuner tuner;
+    size_t loaded = tuner.loadEpd(data, pool);
+    assert(loaded == 5);
+    assert(tuner.getDrawsSkipped() == 1 && tuner.getRejected() == 1);
+
+    // The split into chunks does not change the error
+    ThreadPool single(1);
+    assert(std::abs(tuner.error(pool) - tuner.error(single)) < 1e-12);
+
+    double scale = tuner.fitScale(pool);
+    assert(scale > 0.0005 && scale < 0.05);
+    double before = tuner.error(pool);
+    for (int epoch = 0; epoch < 50; epoch++) tuner.runEpoch(pool, 2.0);
+    assert(tuner.error(pool) < before);
+    assert(tuner.getWeights().pieceValue[QUEEN] != EvalWeights::defaults().pieceValue[QUEEN]);
+    assert(tuner.formatWeights().find("const int KING_TABLE[64] = {") != std::string::npos);
+
+    std::cout << "✓ Tuner test passed\n";
+}
+
+void testMateSolver() {
+    // Checks from generation agree with making every move and looking
+    Board board;
+    bool loaded = board.loadFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    assert(loaded);
+    MoveList all, checks;
+    board.generateLegalMoves(all);
+    board.generateLegalMoves(checks, GEN_CHECKS);
+    int expected = 0;
+    for (const Move& move : all) {
+        board.applyMove(move);
+        if (board.isInCheck(board.getCurrentPlayer())) expected++;
+        board.undoMove();
+    }
+    assert(checks.size() == expected);
+    for (const Move& move : checks) assert(board.givesCheck(move));
+
+    MateSolver solver(1);
+    MateLimits limits;
+    limits.maxMoves = 4;
+    loaded = board.loadFromFEN("r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1");
+    assert(loaded);
+    MateResult result = solver.solve(board, limits);
+    assert(result.status == MATE_PROVEN && result.mateIn == 2);
+    assert(result.line.size() == 3);
+    assert(result.notation == "1. Nf6+ gxf6 2. Bxf7#");
+
+    // Black to move; the numbering starts from the position's move number
+    loaded = board.loadFromFEN("3R4/1p3ppk/8/1R6/5Pr1/8/r1P2P1P/7K b - - 0 27");
+    assert(loaded);
+    result = solver.solve(board, limits);
+    assert(result.status == MATE_PROVEN && result.mateIn == 3);
+    assert(result.notation.substr(0, 11) == "27... Ra1+ ");
+
+    // Checks cannot mate here, and the budget stops a search that could
+    loaded = board.loadFromFEN("6k1/5ppp/8/8/8/8/5PPP/6K1 w - - 0 1");
+    assert(loaded);
+    result = solver.solve(board, limits);
+    assert(result.status == MATE_DISPROVEN);
+    loaded = board.loadFromFEN("2QR4/k5p1/p7/5P2/2p1p1B1/P6P/1q5P/6K1 w - - 1 32");
+    assert(loaded);
+    limits.nodes = 20;
+    result = solver.solve(board, limits);
+    assert(result.status == MATE_UNKNOWN && result.line.empty());
+
+    std::cout << "✓ Mate solver test passed\n";
+}
+
+void testPerftCluster() {
+    // Units cover every position two plies down, largest first
+    Board board;
+    std::vector<WorkUnit> units = PerftCluster::split(board, 4, 2);
+    assert(units.size() == 400);
+    assert(units[0].depth == 2 && units[0].path.size() == 2);
+    uint64_t leaves = 0;
+    for (const WorkUnit& unit : units) {
+        Board child;
+        bool loaded = child.loadFromFEN(unit.fen);
+        assert(loaded);
+        leaves += child.perft(unit.depth);
+    }
+    assert(leaves == 197281);
+
+    Search search;
+    std::string reply = PerftCluster::handleUnit("perft 7 2 " + board.toFEN(), search);
+    assert(reply == "7 400 400");
+    reply = PerftCluster::handleUnit("perft 8 2 not-a-fen", search);
+    assert(reply == "8 error");
+    reply = PerftCluster::handleUnit("split 9 2 " + board.toFEN(), search);
+    assert(reply == "9 error");
+
+#ifndef _WIN32
+    PerftCluster cluster(2);
+    bool started = cluster.start();
+    assert(started);
+    ClusterReport report;
+    bool ok = cluster.perft(board, 4, 2, report);
+    assert(ok && report.nodes == 197281 && report.units == 400);
+    assert(report.unitsPerWorker.size() == 2);
+    assert(report.unitsPerWorker[0] + report.unitsPerWorker[1] == 400);
+
+    // The same workers serve the next request
+    ok = board.loadFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    assert(ok);
+    ok = cluster.perft(board, 3, 1, report);
+    assert(ok && report.nodes == 97862);
+
+    // Back-rank mate: the root side mates in one
+    ok = board.loadFromFEN("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    assert(ok);
+    ok = cluster.analyse(board, 3, report);
+    assert(ok && report.score == Search::MATE_SCORE - 1);
+    assert(board.squareToAlgebraic(report.bestMove.to) == "a8");
+    cluster.stop();
+#endif
+
+    std::cout << "✓ Perft cluster test passed\n";
+}
+
+void testTablebase() {
+    // A directory of its own, so tables already on disk neither count nor
+    // get overwritten
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "chess_test_tablebase";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    TablebaseGenerator generator(2);
+    std::vector<TablebaseReport> reports;
+    bool generated = generator.generate("KvKQ", directory.string(), reports);
+    assert(generated);
+    assert(reports.size() == 1 && reports[0].material == "KQvK");
+
+    // A truncated table is skipped instead of being read past its end
+    {
+        std::ofstream truncated(directory / "KRvK.ctbm", std::ios::binary);
+        truncated.write("CTBM\3", 5);
+        truncated.write(std::string(64, '\0').data(), 64);
+    }
+
+    Tablebase tablebase;
+    bool opened = tablebase.open(directory.string());
+    assert(opened && tablebase.tableCount() == 1);
+
+    int wdl = -2, plies = -1;
+    Board board;
+    bool loaded = board.loadFromFEN("7k/8/6K1/8/8/8/8/1Q6 w - - 0 1");
+    assert(loaded);
+    bool found = tablebase.probeDtm(board, wdl, plies);
+    assert(found && wdl == 1 && plies == 1);
+
+    // Same position with colors reversed
+    board.loadFromFEN("1q6/8/8/8/8/6k1/8/7K b - - 0 1");
+    found = tablebase.probeWdl(board, wdl);
+    assert(found && wdl == 1);
+
+    // Black to move can take the undefended queen
+    board.loadFromFEN("8/8/8/8/8/8/1k6/Q6K b - - 0 1");
+    found = tablebase.probeWdl(board, wdl);
+    assert(found && wdl == 0);
+
+    Game game;
+    game.setTablebase(&tablebase, true);
+    assert(game.getResult() == GAME_ONGOING && !game.isTablebaseResult());
+
+    // Adjudication is reported as such, not as checkmate
+    loaded = game.newGame("7k/8/5K2/8/8/8/8/1Q6 w - - 0 1");
+    assert(loaded && game.getResult() == WHITE_WINS && game.isTablebaseResult());
+    std::ostringstream status;
+    std::streambuf* console = std::cout.rdbuf(status.rdbuf());
+    game.printGameStatus();
+    std::cout.rdbuf(console);
+    assert(status.str().find("Tablebase win") != std::string::npos);
+    assert(status.str().find("Checkmate") == std::string::npos);
+
+    tablebase.close();
+    std::filesystem::remove_all(directory);
+
+    std::cout << "✓ Tablebase test passed\n";
+}
+
+void testSearch() {
+    // Back-rank mate in one
+    Board board;
+    bool loaded = board.loadFromFEN("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    assert(loaded);
+
+    Search search;
+    SearchLimits limits;
+    limits.depth = 3;
+    SearchResult result = search.think(board, limits);
+    assert(board.squareToAlgebraic(result.bestMove.from) == "a1");
+    assert(board.squareToAlgebraic(result.bestMove.to) == "a8");
+    assert(result.score == Search::MATE_SCORE - 1);
+    assert(Notation::toSan(board, result.bestMove) == "Ra8#");
+
+    // MultiPV: distinct root moves, best first, pv matches line one
+    limits.multiPv = 3;
+    result = search.think(board, limits);
+    assert(result.lines.size() == 3);
+    assert(result.lines[0].moves[0].matches(result.bestMove));
+    assert(result.pv.size() == result.lines[0].moves.size());
+    assert(result.lines[0].score == Search::MATE_SCORE - 1);
+    assert(result.lines[0].score >= result.lines[1].score && result.lines[1].score >= result.lines[2].score);
+    assert(!result.lines[1].moves[0].matches(result.lines[2].moves[0]));
+
+    // Without a TT to carry bounds between windows, PVS and aspiration
+    // windows must reach the same score as a full-window search
+    loaded = board.loadFromFEN("r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4");
+    assert(loaded);
+    EngineConfig plainConfig, windowConfig;
+    plainConfig.useTranspositionTable = windowConfig.useTranspositionTable = false;
+    plainConfig.usePvs = false;
+    assert(!plainConfig.useAspiration);
+    bool set = windowConfig.setOption("pvs", "1");
+    assert(set);
+    set = windowConfig.setOption("aspiration", "on");
+    assert(set);
+    Search plain(plainConfig), windowed(windowConfig);
+    limits.multiPv = 1;
+    limits.depth = 5;
+    SearchResult plainResult = plain.think(board, limits);
+    SearchResult windowResult = windowed.think(board, limits);
+    assert(windowResult.score == plainResult.score && windowResult.depth == 5);
+    assert(windowResult.bestMove.matches(plainResult.bestMove));
+
+    MatchStats stats;
+    stats.wins = 30;
+    stats.draws = 40;
+    stats.losses = 30;
+    assert(stats.elo() == 0.0);
+    assert(stats.eloError() > 0.0);
+
+    // Engine names become JSON keys in the --stats output
+    assert(SearchStats::quoteJson("a\"b\\c") == "\"a\\\"b\\\\c\"");
+
+    std::cout << "✓ Search test passed\n";
+}
+
 int main() {
     std::cout << "Running Chess Game Tests...\n\n";
 
@@ -60,6 +875,23 @@ int main() {
         testBasicMove();
         testInvalidMove();
         testMoveGeneration();
+        testPerft();
+        testCastling();
+        testOpeningBook();
+        testFen();
+        testPositionStatus();
+        testReplay();
+        testAnalysisTree();
+        testTimeManagement();
+        testPondering();
+        testBatchEvaluation();
+        testNnue();
+        testAnalysisServer();
+        testTuner();
+        testMateSolver();
+        testPerftCluster();
+        testTablebase();
+        testSearch();
 
         std::cout << "\n✅ All tests passed!\n";
         return 0;